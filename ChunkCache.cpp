@@ -0,0 +1,177 @@
+#include "ChunkCache.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static const uint32_t CHUNK_CACHE_MAGIC = 0x48435354; // "TSCH"
+static const uint32_t CHUNK_CACHE_VERSION = 1;
+static const uint64_t FNV_OFFSET = 14695981039346656037ull;
+
+struct ChunkFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint64_t size;
+};
+
+ChunkCache::ChunkCache(const std::string& directory, uint64_t maxBytes) : directory(directory), maxBytes(maxBytes) {
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+
+    // Existujici zaznamy serazene podle posledniho pouziti
+    std::vector<std::pair<fs::file_time_type, uint64_t>> found;
+    for (const fs::directory_entry& file : fs::directory_iterator(directory, ec)) {
+        if (file.path().extension() != ".chunk")
+            continue;
+        uint64_t key = std::strtoull(file.path().stem().string().c_str(), nullptr, 16);
+        uint64_t size = file.file_size(ec);
+        if (ec || size < sizeof(ChunkFileHeader))
+            continue;
+        entries[key] = Entry{ size, 0 };
+        totalBytes += size;
+        found.push_back({ file.last_write_time(ec), key });
+    }
+    std::sort(found.begin(), found.end());
+    for (const auto& item : found)
+        entries[item.second].lastUsed = ++useClock;
+
+    std::cout << "Chunk cache: " << entries.size() << " zaznamu, " << totalBytes / (1024 * 1024) << " MB\n";
+    Evict();
+}
+
+std::string ChunkCache::PathFor(uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.chunk", static_cast<unsigned long long>(key));
+    return (fs::path(directory) / name).string();
+}
+
+bool ChunkCache::Contains(uint64_t key) const {
+    return entries.count(key) != 0;
+}
+
+bool ChunkCache::Load(uint64_t key, void* data, size_t size) {
+    auto it = entries.find(key);
+    if (it == entries.end() || it->second.size != sizeof(ChunkFileHeader) + size)
+        return false;
+
+    std::string path = PathFor(key);
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file)
+        return false;
+    ChunkFileHeader header;
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1 && header.magic == CHUNK_CACHE_MAGIC &&
+        header.version == CHUNK_CACHE_VERSION && header.key == key && header.size == size &&
+        std::fread(data, 1, size, file) == size;
+    std::fclose(file);
+
+    if (!ok) {
+        // Poskozeny nebo cizi soubor
+        std::error_code ec;
+        fs::remove(path, ec);
+        totalBytes -= it->second.size;
+        entries.erase(it);
+        return false;
+    }
+    it->second.lastUsed = ++useClock;
+    std::error_code ec;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    return true;
+}
+
+void ChunkCache::Store(uint64_t key, const void* data, size_t size) {
+    std::string path = PathFor(key);
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Chunk cache: nelze zapsat " << path << "\n";
+        return;
+    }
+    ChunkFileHeader header = { CHUNK_CACHE_MAGIC, CHUNK_CACHE_VERSION, key, size };
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 && std::fwrite(data, 1, size, file) == size;
+    std::fclose(file);
+    if (!ok) {
+        std::error_code ec;
+        fs::remove(path, ec);
+        return;
+    }
+
+    auto it = entries.find(key);
+    if (it != entries.end())
+        totalBytes -= it->second.size;
+    entries[key] = Entry{ sizeof(ChunkFileHeader) + size, ++useClock };
+    totalBytes += sizeof(ChunkFileHeader) + size;
+    Evict();
+}
+
+void ChunkCache::SetMaxBytes(uint64_t maxBytes) {
+    this->maxBytes = maxBytes;
+    Evict();
+}
+
+void ChunkCache::Evict() {
+    if (totalBytes <= maxBytes)
+        return;
+    std::vector<std::pair<uint64_t, uint64_t>> byAge; // (lastUsed, key)
+    for (const auto& entry : entries)
+        byAge.push_back({ entry.second.lastUsed, entry.first });
+    std::sort(byAge.begin(), byAge.end());
+
+    for (const auto& item : byAge) {
+        if (totalBytes <= maxBytes)
+            break;
+        std::error_code ec;
+        fs::remove(PathFor(item.second), ec);
+        totalBytes -= entries[item.second].size;
+        entries.erase(item.second);
+    }
+}
+
+static uint64_t HashParams(uint64_t h, const Params& p) {
+    const float values[10] = { p.fbmFreq, p.fbmAmp, p.ridgeFreq, p.ridgeAmp, p.voroFreq, p.voroAmp,
+        p.morphedvoroFreq, p.morphedvoroAmp, p.sandFreq, p.sandAmp };
+    h = HashBytes(h, values, sizeof(values));
+    return HashValue(h, p.enabled);
+}
+
+uint64_t HashTerrainParams(const TerrainSettings& settings, const Uniforms& uniforms) {
+    uint64_t h = FNV_OFFSET;
+    h = HashValue(h, settings.seed);
+    h = HashValue(h, settings.scale);
+    h = HashValue(h, settings.edgeSharpness);
+    h = HashValue(h, settings.heightScale);
+    h = HashValue(h, settings.octaves);
+    h = HashValue(h, settings.persistence);
+    h = HashValue(h, settings.lacunarity);
+    h = HashValue(h, int(settings.analyticNormals));
+    h = HashValue(h, int(settings.bakedNoise));
+    h = HashParams(h, uniforms.Dunes);
+    h = HashParams(h, uniforms.Plains);
+    h = HashParams(h, uniforms.Mountains);
+    h = HashParams(h, uniforms.Sea);
+    return h;
+}
+
+uint64_t HashBiomeMap(uint64_t hash, bool enabled, int step) {
+    hash = HashValue(hash, int(enabled));
+    return enabled ? HashValue(hash, step) : hash;
+}
+
+uint64_t HashErosionStep(uint64_t history, const Erosion& erosion, int dropletIdx) {
+    const float values[10] = { erosion.erosionRate, erosion.depositionRate, erosion.inertia,
+        erosion.sedimentCapacityFactor, erosion.minSedimentCapacity, erosion.erodeSpeed, erosion.depositSpeed,
+        erosion.gravity, erosion.initialWaterVolume, erosion.initialSpeed };
+    uint64_t h = HashValue(FNV_OFFSET, history);
+    h = HashBytes(h, values, sizeof(values));
+    h = HashValue(h, erosion.numDroplets);
+    h = HashValue(h, erosion.erosionRadius);
+    if (erosion.model == EROSION_PIPES) {
+        const float pipe[4] = { erosion.pipeCapacity, erosion.rainRate, erosion.evaporationRate, erosion.timeStep };
+        h = HashBytes(HashValue(h, erosion.model), pipe, sizeof(pipe));
+        h = HashValue(h, erosion.pipeIterations);
+    }
+    return HashValue(h, dropletIdx);
+}
@@ -0,0 +1,65 @@
+#ifndef CHUNK_CACHE_H
+#define CHUNK_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include "TerrainTypes.h"
+
+// Diskova cache hotovych dat chunku (pole Output). Kazdy zaznam je jeden soubor <klic>.chunk v adresari
+// cache, klic je hash parametru generovani. Velikost je omezena maxBytes, pri prekroceni se mazou
+// nejdele nepouzite zaznamy (poradi pouziti preziva restart diky casu posledniho zapisu souboru).
+class ChunkCache {
+public:
+    ChunkCache(const std::string& directory, uint64_t maxBytes);
+
+    bool Contains(uint64_t key) const;
+    // false, pokud zaznam chybi nebo ma jinou velikost nez size
+    bool Load(uint64_t key, void* data, size_t size);
+    void Store(uint64_t key, const void* data, size_t size);
+
+    void SetMaxBytes(uint64_t maxBytes);
+    uint64_t GetSizeBytes() const { return totalBytes; }
+    size_t GetEntryCount() const { return entries.size(); }
+
+private:
+    struct Entry {
+        uint64_t size;
+        uint64_t lastUsed;
+    };
+
+    std::string PathFor(uint64_t key) const;
+    void Evict();
+
+    std::string directory;
+    uint64_t maxBytes;
+    uint64_t totalBytes = 0;
+    uint64_t useClock = 0;
+    std::unordered_map<uint64_t, Entry> entries;
+};
+
+// FNV-1a, h je predchozi hash (pro retezeni)
+inline uint64_t HashBytes(uint64_t h, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        h ^= bytes[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+template <typename T>
+inline uint64_t HashValue(uint64_t h, const T& value) {
+    return HashBytes(h, &value, sizeof(T));
+}
+
+// Hash vsech vstupu Terrain.comp (globalni nastaveni a ctyri bloky Params bez paddingu)
+uint64_t HashTerrainParams(const TerrainSettings& settings, const Uniforms& uniforms);
+// Mapa biomu (Terrain::SetBiomeMap) interpoluje vahy a necha jen tri nejsilnejsi biomy, vysledek je tedy
+// jiny nez bez ni. Krok mapy je soucasti hashe jen pri zapnute mape.
+uint64_t HashBiomeMap(uint64_t hash, bool enabled, int step);
+// Dalsi clanek retezce historie eroze
+uint64_t HashErosionStep(uint64_t history, const Erosion& erosion, int dropletIdx);
+
+#endif // CHUNK_CACHE_H
@@ -0,0 +1,242 @@
+#include "ErosionCPU.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+// GLSL fract()
+static float fract(float x) {
+    return x - std::floor(x);
+}
+
+// hash() z Erosion.comp (jiny nez hash() v Terrain.comp)
+static glm::vec2 DropletHash(glm::vec2 p) {
+    glm::vec2 offsetA(127.1f, 311.7f);
+    glm::vec2 offsetB = glm::vec2(269.5f, 183.3f) * 2.0f;
+    return glm::vec2(fract(std::sin(glm::dot(p, offsetA)) * 43758.5453f),
+        fract(std::sin(glm::dot(p, offsetB)) * 43758.5453f));
+}
+
+std::vector<BrushTap> BuildErosionBrush(int radius) {
+    radius = std::max(radius, 1);
+    std::vector<BrushTap> brush = { { glm::ivec2(0), 1.0f, 0.0f } };
+    float sum = 1.0f;
+    for (int y = -radius; y <= radius; y++) {
+        for (int x = -radius; x <= radius; x++) {
+            float weight = 1.0f - std::sqrt(float(x * x + y * y)) / float(radius);
+            if ((x != 0 || y != 0) && weight > 0.0f) {
+                brush.push_back({ glm::ivec2(x, y), weight, 0.0f });
+                sum += weight;
+            }
+        }
+    }
+    for (BrushTap& tap : brush)
+        tap.weight /= sum;
+    return brush;
+}
+
+ErosionCPU::ErosionCPU(int size) : gridSize(size) {
+}
+
+ErosionCPU::~ErosionCPU() {
+    StopWorkers();
+}
+
+void ErosionCPU::StartWorkers(int count) {
+    if (int(workers.size()) == count - 1)
+        return;
+    StopWorkers();
+    for (int t = 1; t < count; t++)
+        workers.emplace_back(&ErosionCPU::WorkerLoop, this, t, passIndex);
+}
+
+void ErosionCPU::StopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(workMutex);
+        stopWorkers = true;
+    }
+    workReady.notify_all();
+    for (std::thread& worker : workers)
+        worker.join();
+    workers.clear();
+    stopWorkers = false;
+}
+
+void ErosionCPU::WorkerLoop(int thread, unsigned int seen) {
+    for (;;) {
+        const std::function<void(int)>* pass;
+        {
+            std::unique_lock<std::mutex> lock(workMutex);
+            workReady.wait(lock, [&]() { return stopWorkers || passIndex != seen; });
+            if (stopWorkers)
+                return;
+            seen = passIndex;
+            pass = currentPass;
+        }
+        (*pass)(thread);
+        std::lock_guard<std::mutex> lock(workMutex);
+        if (--pendingWorkers == 0)
+            workDone.notify_one();
+    }
+}
+
+void ErosionCPU::RunParallel(const std::function<void(int)>& pass) {
+    {
+        std::lock_guard<std::mutex> lock(workMutex);
+        currentPass = &pass;
+        pendingWorkers = int(workers.size());
+        passIndex++;
+    }
+    workReady.notify_all();
+    pass(0);
+    std::unique_lock<std::mutex> lock(workMutex);
+    workDone.wait(lock, [&]() { return pendingWorkers == 0; });
+}
+
+// CalculateHeightAndGradient z Erosion.comp
+float ErosionCPU::HeightAndGradient(const std::vector<Output>& inputs, glm::vec2 pos, glm::vec2& gradient) const {
+    int coordX = int(pos.x);
+    int coordY = int(pos.y);
+
+    float x = fract(pos.x);
+    float y = fract(pos.y);
+
+    int nodeIndexNW = coordY * gridSize + coordX;
+    bool hasNextX = coordX + 1 < gridSize;
+    bool hasNextY = coordY + 1 < gridSize;
+
+    float heightNW = inputs[nodeIndexNW].position.y;
+    float heightNE = hasNextX ? inputs[nodeIndexNW + 1].position.y : heightNW;
+    float heightSW = hasNextY ? inputs[nodeIndexNW + gridSize].position.y : heightNW;
+    float heightSE = hasNextX && hasNextY ? inputs[nodeIndexNW + gridSize + 1].position.y : heightNW;
+
+    float gradientX = (heightNE - heightNW) * (1 - y) + (heightSE - heightSW) * y;
+    float gradientY = (heightSW - heightNW) * (1 - x) + (heightSE - heightNE) * x;
+
+    float height = heightNW * (1 - x) * (1 - y) + heightNE * x * (1 - y) + heightSW * (1 - x) * y + heightSE * x * y;
+    gradient = glm::vec2(gradientX, gradientY);
+    return height;
+}
+
+void ErosionCPU::ScatterBrush(std::vector<int>& deltas, glm::ivec2 cell, int amount) const {
+    int remaining = amount;
+    for (size_t i = 1; i < brush.size(); i++) {
+        glm::ivec2 p = cell + brush[i].offset;
+        if (p.x < 0 || p.y < 0 || p.x >= gridSize || p.y >= gridSize)
+            continue;
+        int part = int(float(amount) * brush[i].weight);
+        deltas[size_t(p.y) * gridSize + p.x] += part;
+        remaining -= part;
+    }
+    deltas[size_t(cell.y) * gridSize + cell.x] += remaining;
+}
+
+void ErosionCPU::SimulateDroplet(const std::vector<Output>& inputs, std::vector<int>& deltas, const Erosion& erosion,
+    int dropletIdx, int x, int y) const {
+    glm::vec2 chunkPos = glm::vec2(float(x), float(y));
+    glm::vec2 dropletPos = chunkPos + DropletHash(glm::vec2(float(x + dropletIdx), float(y + dropletIdx)));
+
+    float speed = erosion.initialSpeed;
+    float water = erosion.initialWaterVolume;
+    float sediment = 0.0f;
+    glm::vec2 direction(0.0f);
+
+    for (int i = 0; i < MAX_STEPS; i++) {
+        if (water <= 0.01f || speed <= 0.01f)
+            break;
+        glm::vec2 gradient, temp;
+        float prevHeight = HeightAndGradient(inputs, dropletPos, gradient);
+        glm::vec2 nextDirection = direction * erosion.inertia - gradient * (1.0f - erosion.inertia);
+        if (glm::length(nextDirection) < 0.0001f)
+            break;
+
+        glm::vec2 nextPos = dropletPos + nextDirection * 0.5f;
+        if (nextPos.x < 0.0f || nextPos.x >= gridSize - 1 || nextPos.y < 0.0f || nextPos.y >= gridSize - 1)
+            break;
+
+        float newHeight = HeightAndGradient(inputs, nextPos, temp);
+        float deltaHeight = newHeight - prevHeight;
+        float capacity = std::max(-deltaHeight * speed * water * erosion.sedimentCapacityFactor, erosion.minSedimentCapacity);
+
+        if (sediment > capacity || deltaHeight > 0.0f) {
+            float amountToDeposit = deltaHeight > 0.0f
+                ? std::min(deltaHeight, sediment)
+                : (sediment - capacity) * erosion.depositSpeed;
+            int totalDeposit = int(amountToDeposit * PRECISION * erosion.depositionRate);
+
+            if (totalDeposit > 0) {
+                ScatterBrush(deltas, glm::ivec2(dropletPos), totalDeposit);
+                sediment -= float(totalDeposit) / PRECISION;
+            }
+        }
+        else {
+            float slope = glm::length(temp);
+            float erosionFromCapacity = (capacity - sediment) * erosion.erodeSpeed;
+            float rawErosion = erosionFromCapacity * slope;
+            float amountToErode = std::min(rawErosion, -deltaHeight);
+
+            if (amountToErode > 0.0f) {
+                size_t idx = size_t(dropletPos.y) * gridSize + size_t(dropletPos.x);
+                float currentHeight = inputs[idx].position.y;
+                float maxErode = std::max(currentHeight - 0.01f, 0.0f);
+                float finalErode = std::min(amountToErode, maxErode);
+                ScatterBrush(deltas, glm::ivec2(dropletPos), -int(finalErode * PRECISION * erosion.erosionRate));
+                sediment += finalErode;
+            }
+        }
+
+        direction = nextDirection;
+        dropletPos = nextPos;
+        speed = std::sqrt(speed * speed + deltaHeight * erosion.gravity);
+        water *= (1.0f - 0.005f);
+    }
+}
+
+void ErosionCPU::Step(std::vector<Output>& outputs, const Erosion& erosion, int dropletIdx, int threadCount) {
+    size_t texels = size_t(gridSize) * gridSize;
+    if (outputs.size() < texels)
+        return;
+    if (threadCount <= 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    threadCount = std::min(threadCount, gridSize);
+    if (brushRadius != erosion.erosionRadius) {
+        brush = BuildErosionBrush(erosion.erosionRadius);
+        brushRadius = erosion.erosionRadius;
+    }
+    // Nove buffery jsou nulove, pouzite vynuloval apply minuleho kroku
+    if (int(threadDeltas.size()) < threadCount)
+        threadDeltas.resize(threadCount);
+    for (int t = 0; t < threadCount; t++) {
+        if (threadDeltas[t].size() != texels)
+            threadDeltas[t].assign(texels, 0);
+    }
+    StartWorkers(threadCount);
+
+    // Erosion.comp: kapky ctou jen vysky pred krokem, zmeny jdou do bufferu vlakna
+    std::atomic<int> nextRow(0);
+    auto simulate = [&](int t) {
+        for (int y = nextRow++; y < gridSize; y = nextRow++) {
+            for (int x = 0; x < gridSize; x++)
+                SimulateDroplet(outputs, threadDeltas[t], erosion, dropletIdx, x, y);
+        }
+    };
+    // ErosionApply.comp: soucet bufferu v poradi vlaken, pak stejne orezani zmeny jako na GPU.
+    // Prectene hodnoty se hned nuluji pro dalsi krok.
+    auto apply = [&](int t) {
+        for (int y = t; y < gridSize; y += threadCount) {
+            for (int x = 0; x < gridSize; x++) {
+                size_t index = size_t(y) * gridSize + x;
+                int delta = 0;
+                for (int i = 0; i < threadCount; i++) {
+                    delta += threadDeltas[i][index];
+                    threadDeltas[i][index] = 0;
+                }
+                float change = std::clamp(float(delta) / PRECISION, -0.5f, 0.5f);
+                outputs[index].position.y = std::clamp(outputs[index].position.y + change, -10.0f, 1000.0f);
+            }
+        }
+    };
+
+    RunParallel(simulate);
+    RunParallel(apply);
+}
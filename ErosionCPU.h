@@ -0,0 +1,69 @@
+#ifndef EROSION_CPU_H
+#define EROSION_CPU_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <glm/glm.hpp>
+#include "TerrainTypes.h"
+
+// Stetec pro polomer radius: stred s posunem (0, 0) prvni, vahy max(0, 1 - vzdalenost / radius)
+// normalizovane na soucet 1. Pocita se jednou pro polomer, Terrain ho nahrava do SSBO pro Erosion.comp.
+std::vector<BrushTap> BuildErosionBrush(int radius);
+
+// CPU port kapkove eroze z Shaders/Erosion.comp a ErosionApply.comp (stejny model kapky, kapacita,
+// pravidla ukladani a eroze stetcem i akumulace v pevne radove carce PRECISION).
+//
+// Kazde vlakno pousti kapky z radku, ktere si bere z citace, a scita zmeny do vlastniho bufferu intu.
+// Vlakna i buffery zustavaji mezi kroky, buffery nuluje az pruchod, ktery je scita.
+// Buffery se pak sectou v pevnem poradi - soucet celych cisel nezavisi na poradi kapek, takze vysledek
+// je bitove stejny pro libovolny pocet vlaken a behy (regresni reference). Oproti GPU se lisi jen
+// presnost sin v hashi kapek a float operace, shoda je tedy priblizna.
+class ErosionCPU {
+public:
+    static constexpr int PRECISION = 1024 * 16; // PRECISION / BRUSHPREC v shaderech
+    static constexpr int MAX_STEPS = 50;         // kroku kapky v Erosion.comp
+
+    explicit ErosionCPU(int size);
+    ~ErosionCPU();
+
+    // Jeden krok eroze nad outputs (gridSize * gridSize): kapka z kazdeho texelu, dropletIdx posouva hash
+    // kapek jako uniform dropletIdx. threadCount <= 0 znamena vsechna jadra.
+    void Step(std::vector<Output>& outputs, const Erosion& erosion, int dropletIdx, int threadCount = 0);
+
+    // Pocet kapek jednoho kroku
+    long long DropletsPerStep() const { return (long long)gridSize * gridSize; }
+
+    int gridSize;
+
+private:
+    // Erosion.comp main() pro kapku z texelu (x, y), zmeny vysek pricita do deltas
+    void SimulateDroplet(const std::vector<Output>& inputs, std::vector<int>& deltas, const Erosion& erosion,
+        int dropletIdx, int x, int y) const;
+    float HeightAndGradient(const std::vector<Output>& inputs, glm::vec2 pos, glm::vec2& gradient) const;
+    // scatterBrush() z Erosion.comp
+    void ScatterBrush(std::vector<int>& deltas, glm::ivec2 cell, int amount) const;
+
+    // Pracovni vlakna 1..count-1 (vlakno 0 je volajici), pri zmene poctu se vytvori znovu
+    void StartWorkers(int count);
+    void StopWorkers();
+    // seen = posledni pruchod pred vznikem vlakna, ten uz nespousti
+    void WorkerLoop(int thread, unsigned int seen);
+    // Spusti pass(t) na vsech vlaknech a pocka na dokonceni
+    void RunParallel(const std::function<void(int)>& pass);
+
+    std::vector<std::vector<int>> threadDeltas; // buffer zmen pro kazde vlakno, mezi kroky vynulovany
+    std::vector<std::thread> workers;
+    std::mutex workMutex;
+    std::condition_variable workReady, workDone;
+    const std::function<void(int)>* currentPass = nullptr;
+    unsigned int passIndex = 0; // zvysuje se s kazdym pruchodem, vlakna na nej cekaji
+    int pendingWorkers = 0;
+    bool stopWorkers = false;
+    std::vector<BrushTap> brush;
+    int brushRadius = -1;                       // polomer, pro ktery je brush spocitany
+};
+
+#endif // EROSION_CPU_H
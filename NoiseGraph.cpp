@@ -0,0 +1,535 @@
+#include "NoiseGraph.h"
+#include "TerrainCPU.h"
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <tuple>
+
+// Nazvy podle ID biomu a poradi NoiseParamField, zaroven nazvy v UBO Terrain.comp
+static const char* BIOME_NAMES[4] = { "Sea", "Plains", "Mountains", "Dunes" };
+static const char* FIELD_NAMES[FIELD_COUNT] = { "fbmFreq", "fbmAmp", "ridgeFreq", "ridgeAmp", "voroFreq", "voroAmp",
+    "morphedvoroFreq", "morphedvoroAmp", "sandFreq", "sandAmp" };
+static float Params::* const FIELD_MEMBERS[FIELD_COUNT] = { &Params::fbmFreq, &Params::fbmAmp, &Params::ridgeFreq,
+    &Params::ridgeAmp, &Params::voroFreq, &Params::voroAmp, &Params::morphedvoroFreq, &Params::morphedvoroAmp,
+    &Params::sandFreq, &Params::sandAmp };
+
+static bool IsCoordOp(NoiseOp op) {
+    return op == NoiseOp::Position || op == NoiseOp::Scale || op == NoiseOp::Warp;
+}
+
+int NoiseGraph::Push(const NoiseNode& node) {
+    nodes.push_back(node);
+    return int(nodes.size()) - 1;
+}
+
+int NoiseGraph::Constant(float value) {
+    NoiseNode node{ NoiseOp::Constant };
+    node.value = value;
+    return Push(node);
+}
+
+int NoiseGraph::Param(int biome, int field) {
+    NoiseNode node{ NoiseOp::Param };
+    node.biome = biome;
+    node.field = field;
+    return Push(node);
+}
+
+int NoiseGraph::Position() {
+    return Push(NoiseNode{ NoiseOp::Position });
+}
+
+int NoiseGraph::Scale(int coord, int factor) {
+    return Push(NoiseNode{ NoiseOp::Scale, coord, factor });
+}
+
+int NoiseGraph::Warp(int coord, int source, float strength, float distortion) {
+    return Push(NoiseNode{ NoiseOp::Warp, coord, source, strength, distortion });
+}
+
+int NoiseGraph::Fbm(int coord) {
+    return Push(NoiseNode{ NoiseOp::Fbm, coord });
+}
+
+int NoiseGraph::Ridge(int coord) {
+    return Push(NoiseNode{ NoiseOp::Ridge, coord });
+}
+
+int NoiseGraph::Voronoi(int coord, float sharpness, float baseScale) {
+    return Push(NoiseNode{ NoiseOp::Voronoi, coord, -1, sharpness, baseScale });
+}
+
+int NoiseGraph::Dunes(int coord) {
+    return Push(NoiseNode{ NoiseOp::Dunes, coord });
+}
+
+int NoiseGraph::Add(int a, int b) {
+    return Push(NoiseNode{ NoiseOp::Add, a, b });
+}
+
+int NoiseGraph::Mul(int a, int b) {
+    return Push(NoiseNode{ NoiseOp::Mul, a, b });
+}
+
+bool NoiseGraph::IsCoord(int node) const {
+    return IsCoordOp(nodes[node].op);
+}
+
+// Cleny ve stejnem poradi a se stejnymi konstantami jako combinedNoise v Terrain.comp
+NoiseGraph BiomeNoiseGraph(int biomeID, const Params& params) {
+    NoiseGraph g;
+    int pos = g.Position();
+    int sum = -1;
+    auto term = [&](int node) { sum = sum < 0 ? node : g.Add(sum, node); };
+    auto param = [&](int field) { return g.Param(biomeID, field); };
+
+    if (params.fbmAmp != 0.0f)
+        term(g.Mul(g.Fbm(g.Scale(pos, param(FIELD_FBM_FREQ))), param(FIELD_FBM_AMP)));
+    if (params.voroAmp != 0.0f) {
+        int voro = g.Voronoi(g.Scale(pos, param(FIELD_VORO_FREQ)), 0.4f, 1.5f);
+        term(g.Mul(g.Mul(voro, param(FIELD_VORO_AMP)), g.Constant(0.8f)));
+    }
+    if (params.morphedvoroAmp != 0.0f) {
+        int warped = g.Warp(g.Scale(pos, param(FIELD_MORPHED_FREQ)), pos);
+        term(g.Mul(g.Mul(g.Voronoi(warped, 0.6f, 1.2f), param(FIELD_MORPHED_AMP)), g.Constant(0.2f)));
+    }
+    if (params.ridgeAmp != 0.0f)
+        term(g.Mul(g.Ridge(g.Scale(pos, param(FIELD_RIDGE_FREQ))), param(FIELD_RIDGE_AMP)));
+    if (params.sandAmp != 0.0f)
+        term(g.Mul(g.Dunes(g.Scale(pos, param(FIELD_SAND_FREQ))), param(FIELD_SAND_AMP)));
+
+    g.output = sum >= 0 ? sum : g.Constant(0.0f);
+    return g;
+}
+
+static bool ParseFloat(const std::string& token, float& value) {
+    char* end = nullptr;
+    value = std::strtof(token.c_str(), &end);
+    return end != token.c_str() && *end == '\0';
+}
+
+static int FindName(const char* const* names, int count, const std::string& name) {
+    for (int i = 0; i < count; i++) {
+        std::string lower = names[i];
+        for (char& c : lower)
+            c = char(std::tolower(static_cast<unsigned char>(c)));
+        if (name == names[i] || name == lower)
+            return i;
+    }
+    return -1;
+}
+
+bool ParseNoiseGraph(const std::string& text, NoiseGraph& graph, std::string& error) {
+    NoiseGraph parsed;
+    std::map<std::string, int> names;
+    std::istringstream stream(text);
+    std::string line;
+    int lineNumber = 0;
+    int last = -1;
+
+    while (std::getline(stream, line)) {
+        lineNumber++;
+        std::istringstream tokens(line.substr(0, line.find('#')));
+        std::string name, eq, op, token;
+        if (!(tokens >> name))
+            continue;
+        std::vector<std::string> args;
+        if (tokens >> eq >> op) {
+            while (tokens >> token)
+                args.push_back(token);
+        }
+        // Argument na miste uzlu: jmeno drive definovaneho uzlu nebo cislo (konstanta)
+        auto nodeArg = [&](size_t i, bool coord) {
+            auto it = names.find(args[i]);
+            float value;
+            int node = it != names.end() ? it->second : ParseFloat(args[i], value) ? parsed.Constant(value) : -1;
+            return node >= 0 && parsed.IsCoord(node) == coord ? node : -1;
+        };
+
+        int result = -1;
+        float f0 = 0.0f, f1 = 0.0f;
+        size_t argCount = args.size();
+        if (eq != "=") {
+            result = -1;
+        }
+        else if (op == "pos" && argCount == 0) {
+            result = parsed.Position();
+        }
+        else if (op == "const" && argCount == 1 && ParseFloat(args[0], f0)) {
+            result = parsed.Constant(f0);
+        }
+        else if (op == "param" && argCount == 2) {
+            int biome = FindName(BIOME_NAMES, 4, args[0]);
+            int field = FindName(FIELD_NAMES, FIELD_COUNT, args[1]);
+            if (biome >= 0 && field >= 0)
+                result = parsed.Param(biome, field);
+        }
+        else if (op == "scale" && argCount == 2) {
+            int coord = nodeArg(0, true), factor = nodeArg(1, false);
+            if (coord >= 0 && factor >= 0)
+                result = parsed.Scale(coord, factor);
+        }
+        else if (op == "warp" && (argCount == 2 || argCount == 4)) {
+            int coord = nodeArg(0, true), source = nodeArg(1, true);
+            f0 = 2.0f;
+            f1 = 0.5f;
+            bool ok = argCount == 2 || (ParseFloat(args[2], f0) && ParseFloat(args[3], f1));
+            if (coord >= 0 && source >= 0 && ok)
+                result = parsed.Warp(coord, source, f0, f1);
+        }
+        else if ((op == "fbm" || op == "ridge" || op == "dunes") && argCount == 1) {
+            int coord = nodeArg(0, true);
+            if (coord >= 0)
+                result = op == "fbm" ? parsed.Fbm(coord) : op == "ridge" ? parsed.Ridge(coord) : parsed.Dunes(coord);
+        }
+        else if (op == "voronoi" && argCount == 3) {
+            int coord = nodeArg(0, true);
+            if (coord >= 0 && ParseFloat(args[1], f0) && ParseFloat(args[2], f1))
+                result = parsed.Voronoi(coord, f0, f1);
+        }
+        else if ((op == "add" || op == "mul") && argCount == 2) {
+            int a = nodeArg(0, false), b = nodeArg(1, false);
+            if (a >= 0 && b >= 0)
+                result = op == "add" ? parsed.Add(a, b) : parsed.Mul(a, b);
+        }
+
+        if (result < 0) {
+            error = "radek " + std::to_string(lineNumber) + ": neplatna operace nebo argumenty '" + line + "'";
+            return false;
+        }
+        names[name] = result;
+        last = result;
+    }
+
+    if (last < 0 || parsed.IsCoord(last)) {
+        error = last < 0 ? "prazdny graf" : "vystupem grafu musi byt skalar, ne souradnice";
+        return false;
+    }
+    parsed.output = last;
+    graph = parsed;
+    return true;
+}
+
+bool LoadNoiseGraph(const std::string& path, NoiseGraph& graph, std::string& error) {
+    std::ifstream file(path);
+    if (!file) {
+        error = "nelze otevrit " + path;
+        return false;
+    }
+    std::stringstream text;
+    text << file.rdbuf();
+    return ParseNoiseGraph(text.str(), graph, error);
+}
+
+NoiseGraph CompileNoiseGraph(const NoiseGraph& graph) {
+    NoiseGraph folded;
+    if (graph.Empty())
+        return folded;
+
+    // Shodne uzly (stejna operace, vstupy i konstanty) se slouci do jednoho
+    std::map<std::tuple<int, int, int, float, float, int, int>, int> unique;
+    auto intern = [&](const NoiseNode& n) {
+        auto key = std::make_tuple(int(n.op), n.a, n.b, n.value, n.value2, n.biome, n.field);
+        auto it = unique.find(key);
+        if (it != unique.end())
+            return it->second;
+        folded.nodes.push_back(n);
+        int index = int(folded.nodes.size()) - 1;
+        unique[key] = index;
+        return index;
+    };
+    auto constant = [&](float value) {
+        NoiseNode n{ NoiseOp::Constant };
+        n.value = value;
+        return intern(n);
+    };
+    auto isConstant = [&](int node, float& value) {
+        if (node < 0 || folded.nodes[node].op != NoiseOp::Constant)
+            return false;
+        value = folded.nodes[node].value;
+        return true;
+    };
+
+    std::vector<int> remap(graph.nodes.size(), -1);
+    for (size_t i = 0; i < graph.nodes.size(); i++) {
+        NoiseNode n = graph.nodes[i];
+        if (n.a >= 0) n.a = remap[n.a];
+        if (n.b >= 0) n.b = remap[n.b];
+        float ca = 0.0f, cb = 0.0f;
+        bool constA = isConstant(n.a, ca), constB = isConstant(n.b, cb);
+
+        int result = -1;
+        switch (n.op) {
+        case NoiseOp::Add:
+            if (constA && constB) result = constant(ca + cb);
+            else if (constA && ca == 0.0f) result = n.b;
+            else if (constB && cb == 0.0f) result = n.a;
+            break;
+        case NoiseOp::Mul:
+            if (constA && constB) result = constant(ca * cb);
+            else if ((constA && ca == 0.0f) || (constB && cb == 0.0f)) result = constant(0.0f);
+            else if (constA && ca == 1.0f) result = n.b;
+            else if (constB && cb == 1.0f) result = n.a;
+            break;
+        case NoiseOp::Scale:
+            if (constB && cb == 1.0f) result = n.a;
+            break;
+        case NoiseOp::Warp:
+            if (n.value == 0.0f && n.value2 == 0.0f) result = n.a;
+            break;
+        default:
+            break;
+        }
+        remap[i] = result >= 0 ? result : intern(n);
+    }
+    folded.output = remap[graph.output];
+
+    // Mrtve uzly: zustanou jen ty, na kterych vystup zavisi (topologicke poradi se zachova)
+    std::vector<char> live(folded.nodes.size(), 0);
+    live[folded.output] = 1;
+    for (int i = int(folded.nodes.size()) - 1; i >= 0; i--) {
+        if (!live[i])
+            continue;
+        if (folded.nodes[i].a >= 0) live[folded.nodes[i].a] = 1;
+        if (folded.nodes[i].b >= 0) live[folded.nodes[i].b] = 1;
+    }
+    NoiseGraph compiled;
+    std::vector<int> index(folded.nodes.size(), -1);
+    for (size_t i = 0; i < folded.nodes.size(); i++) {
+        if (!live[i])
+            continue;
+        NoiseNode n = folded.nodes[i];
+        if (n.a >= 0) n.a = index[n.a];
+        if (n.b >= 0) n.b = index[n.b];
+        index[i] = int(compiled.nodes.size());
+        compiled.nodes.push_back(n);
+    }
+    compiled.output = index[folded.output];
+    return compiled;
+}
+
+// Nejkratsi zapis, ktery se precte zpet jako stejny float
+static std::string FloatLiteral(float value) {
+    char text[32];
+    for (int precision = 6; precision <= 9; precision++) {
+        std::snprintf(text, sizeof(text), "%.*g", precision, value);
+        if (std::strtof(text, nullptr) == value)
+            break;
+    }
+    std::string literal = text;
+    if (literal.find_first_of(".e") == std::string::npos)
+        literal += ".0";
+    return literal;
+}
+
+// Telo funkce po radcich; hodnota uzlu i je nI, u souradnic navic nIx, nIy = gradient slozky x, y podle pos
+static void EmitGraphBody(const NoiseGraph& g, bool deriv, std::vector<std::string>& lines) {
+    for (size_t i = 0; i < g.nodes.size(); i++) {
+        const NoiseNode& n = g.nodes[i];
+        std::string v = "n" + std::to_string(i);
+        std::string a = "n" + std::to_string(n.a), b = "n" + std::to_string(n.b);
+        std::string scalar = deriv ? "    vec3 " : "    float ";
+        switch (n.op) {
+        case NoiseOp::Constant:
+            lines.push_back(scalar + v + (deriv ? " = vec3(" + FloatLiteral(n.value) + ", 0.0, 0.0);" : " = " + FloatLiteral(n.value) + ";"));
+            break;
+        case NoiseOp::Param: {
+            std::string field = std::string("u.") + BIOME_NAMES[n.biome] + "." + FIELD_NAMES[n.field];
+            lines.push_back(scalar + v + (deriv ? " = vec3(" + field + ", 0.0, 0.0);" : " = " + field + ";"));
+            break;
+        }
+        case NoiseOp::Position:
+            lines.push_back("    vec2 " + v + " = pos;");
+            if (deriv)
+                lines.push_back("    vec2 " + v + "x = vec2(1.0, 0.0), " + v + "y = vec2(0.0, 1.0);");
+            break;
+        case NoiseOp::Scale:
+            if (!deriv) {
+                lines.push_back("    vec2 " + v + " = " + a + " * " + b + ";");
+                break;
+            }
+            lines.push_back("    vec2 " + v + " = " + a + " * " + b + ".x;");
+            lines.push_back("    vec2 " + v + "x = " + a + "x * " + b + ".x + " + a + ".x * " + b + ".yz;");
+            lines.push_back("    vec2 " + v + "y = " + a + "y * " + b + ".x + " + a + ".y * " + b + ".yz;");
+            break;
+        case NoiseOp::Warp: {
+            std::string strength = FloatLiteral(n.value), distortion = FloatLiteral(n.value2);
+            if (!deriv) {
+                lines.push_back("    float w" + std::to_string(i) + " = fbm(" + b + ");");
+                lines.push_back("    vec2 " + v + " = " + a + " + vec2(w" + std::to_string(i) + ", fbm(" + b + " + vec2(4.3, 2.1))) * " +
+                    strength + " + w" + std::to_string(i) + " * " + distortion + ";");
+                break;
+            }
+            std::string wx = "wx" + std::to_string(i), wy = "wy" + std::to_string(i);
+            std::string gx = "gx" + std::to_string(i), gy = "gy" + std::to_string(i);
+            lines.push_back("    vec3 " + wx + " = fbmD(" + b + "), " + wy + " = fbmD(" + b + " + vec2(4.3, 2.1));");
+            lines.push_back("    vec2 " + gx + " = " + wx + ".y * " + b + "x + " + wx + ".z * " + b + "y;");
+            lines.push_back("    vec2 " + gy + " = " + wy + ".y * " + b + "x + " + wy + ".z * " + b + "y;");
+            lines.push_back("    vec2 " + v + " = " + a + " + vec2(" + wx + ".x, " + wy + ".x) * " + strength + " + " + wx + ".x * " + distortion + ";");
+            lines.push_back("    vec2 " + v + "x = " + a + "x + " + gx + " * " + strength + " + " + gx + " * " + distortion + ";");
+            lines.push_back("    vec2 " + v + "y = " + a + "y + " + gy + " * " + strength + " + " + gx + " * " + distortion + ";");
+            break;
+        }
+        case NoiseOp::Fbm:
+        case NoiseOp::Ridge:
+        case NoiseOp::Voronoi:
+        case NoiseOp::Dunes: {
+            std::string call;
+            if (n.op == NoiseOp::Fbm) call = deriv ? "fbmD(" + a + ")" : "fbm(" + a + ")";
+            else if (n.op == NoiseOp::Ridge) call = (deriv ? "ridgeNoiseD(" : "ridgeNoise(") + a + ", scale * 2.0)";
+            else if (n.op == NoiseOp::Dunes) call = (deriv ? "sandDunesD(" : "sandDunes(") + a + ", edgeSharpness, scale)";
+            else call = (deriv ? "voronoiNoiseD(" : "voronoiNoise(") + a + ", edgeSharpness * " + FloatLiteral(n.value) +
+                ", scale * " + FloatLiteral(n.value2) + ")";
+            if (!deriv) {
+                lines.push_back("    float " + v + " = " + call + ";");
+                break;
+            }
+            // Retizkove pravidlo pres gradienty slozek souradnice
+            std::string t = "t" + std::to_string(i);
+            lines.push_back("    vec3 " + t + " = " + call + ";");
+            lines.push_back("    vec3 " + v + " = vec3(" + t + ".x, " + t + ".y * " + a + "x + " + t + ".z * " + a + "y);");
+            break;
+        }
+        case NoiseOp::Add:
+            lines.push_back(scalar + v + " = " + a + " + " + b + ";");
+            break;
+        case NoiseOp::Mul:
+            if (deriv)
+                lines.push_back("    vec3 " + v + " = vec3(" + a + ".x * " + b + ".x, " + a + ".yz * " + b + ".x + " + a + ".x * " + b + ".yz);");
+            else
+                lines.push_back("    float " + v + " = " + a + " * " + b + ";");
+            break;
+        }
+    }
+    lines.push_back("    return n" + std::to_string(g.output) + ";");
+}
+
+// Vse jako jedno makro (pokracovani radku), aby slo vlozit za #version a rozvinout az za definicemi sumu
+std::string EmitNoiseGraphsGLSL(const NoiseGraph graphs[4]) {
+    std::vector<std::string> lines;
+    for (int id = 1; id < 4; id++) {
+        if (graphs[id].Empty())
+            continue;
+        lines.push_back("float graphNoise" + std::to_string(id) + "(vec2 pos) {");
+        EmitGraphBody(graphs[id], false, lines);
+        lines.push_back("}");
+        lines.push_back("vec3 graphNoise" + std::to_string(id) + "D(vec2 pos) {");
+        EmitGraphBody(graphs[id], true, lines);
+        lines.push_back("}");
+    }
+    for (int deriv = 0; deriv < 2; deriv++) {
+        lines.push_back(deriv ? "vec3 graphBiomeNoiseD(uint id, vec2 pos) {" : "float graphBiomeNoise(uint id, vec2 pos) {");
+        lines.push_back("    switch (id) {");
+        for (int id = 1; id < 4; id++) {
+            if (!graphs[id].Empty())
+                lines.push_back("    case " + std::to_string(id) + "u: return graphNoise" + std::to_string(id) + (deriv ? "D" : "") + "(pos);");
+        }
+        lines.push_back("    }");
+        lines.push_back(deriv ? "    return vec3(0.0);" : "    return 0.0;");
+        lines.push_back("}");
+    }
+
+    std::string code = "#define NOISE_GRAPH_CODE";
+    for (const std::string& line : lines)
+        code += " \\\n" + line;
+    return code + "\n";
+}
+
+static float ParamValue(const NoiseNode& n, const Uniforms& u) {
+    const Params* biomes[4] = { &u.Sea, &u.Plains, &u.Mountains, &u.Dunes };
+    return biomes[n.biome]->*FIELD_MEMBERS[n.field];
+}
+
+float EvaluateNoiseGraph(const NoiseGraph& graph, glm::vec2 pos, const TerrainSettings& s, const Uniforms& u) {
+    if (graph.Empty())
+        return 0.0f;
+    // Skalary i souradnice v jednom poli (skalar v x), buffer se mezi volanimi ve vlakne nealokuje
+    thread_local std::vector<glm::vec2> values;
+    values.resize(graph.nodes.size());
+
+    for (size_t i = 0; i < graph.nodes.size(); i++) {
+        const NoiseNode& n = graph.nodes[i];
+        glm::vec2 a = n.a >= 0 ? values[n.a] : glm::vec2(0.0f);
+        glm::vec2 b = n.b >= 0 ? values[n.b] : glm::vec2(0.0f);
+        glm::vec2& v = values[i];
+        switch (n.op) {
+        case NoiseOp::Constant: v.x = n.value; break;
+        case NoiseOp::Param: v.x = ParamValue(n, u); break;
+        case NoiseOp::Position: v = pos; break;
+        case NoiseOp::Scale: v = a * b.x; break;
+        case NoiseOp::Warp: {
+            float w = fbm(b, s);
+            v = a + glm::vec2(w, fbm(b + glm::vec2(4.3f, 2.1f), s)) * n.value + w * n.value2;
+            break;
+        }
+        case NoiseOp::Fbm: v.x = fbm(a, s); break;
+        case NoiseOp::Ridge: v.x = ridgeNoise(a, s); break;
+        case NoiseOp::Voronoi: v.x = voronoiNoise(a, s.edgeSharpness * n.value, s.scale * n.value2, s.seed); break;
+        case NoiseOp::Dunes: v.x = sandDunes(a, s.edgeSharpness, s.scale); break;
+        case NoiseOp::Add: v.x = a.x + b.x; break;
+        case NoiseOp::Mul: v.x = a.x * b.x; break;
+        }
+    }
+    return values[graph.output].x;
+}
+
+glm::vec3 EvaluateNoiseGraphD(const NoiseGraph& graph, glm::vec2 pos, const TerrainSettings& s, const Uniforms& u) {
+    if (graph.Empty())
+        return glm::vec3(0.0f);
+    // Skalar: (hodnota, d/dx, d/dy); souradnice: q a gradienty slozek qx, qy
+    struct Value {
+        glm::vec3 s;
+        glm::vec2 q, qx, qy;
+    };
+    thread_local std::vector<Value> values;
+    values.resize(graph.nodes.size());
+
+    auto chain = [](glm::vec3 t, const Value& c) {
+        return glm::vec3(t.x, t.y * c.qx + t.z * c.qy);
+    };
+
+    for (size_t i = 0; i < graph.nodes.size(); i++) {
+        const NoiseNode& n = graph.nodes[i];
+        const Value& a = values[n.a >= 0 ? n.a : i];
+        const Value& b = values[n.b >= 0 ? n.b : i];
+        Value v = {};
+        switch (n.op) {
+        case NoiseOp::Constant: v.s = glm::vec3(n.value, 0.0f, 0.0f); break;
+        case NoiseOp::Param: v.s = glm::vec3(ParamValue(n, u), 0.0f, 0.0f); break;
+        case NoiseOp::Position:
+            v.q = pos;
+            v.qx = glm::vec2(1.0f, 0.0f);
+            v.qy = glm::vec2(0.0f, 1.0f);
+            break;
+        case NoiseOp::Scale: {
+            glm::vec2 ds(b.s.y, b.s.z);
+            v.q = a.q * b.s.x;
+            v.qx = a.qx * b.s.x + a.q.x * ds;
+            v.qy = a.qy * b.s.x + a.q.y * ds;
+            break;
+        }
+        case NoiseOp::Warp: {
+            glm::vec3 wx = fbmD(b.q, s), wy = fbmD(b.q + glm::vec2(4.3f, 2.1f), s);
+            glm::vec2 gx = wx.y * b.qx + wx.z * b.qy;
+            glm::vec2 gy = wy.y * b.qx + wy.z * b.qy;
+            v.q = a.q + glm::vec2(wx.x, wy.x) * n.value + wx.x * n.value2;
+            v.qx = a.qx + gx * n.value + gx * n.value2;
+            v.qy = a.qy + gy * n.value + gx * n.value2;
+            break;
+        }
+        case NoiseOp::Fbm: v.s = chain(fbmD(a.q, s), a); break;
+        case NoiseOp::Ridge: v.s = chain(ridgeNoiseD(a.q, s), a); break;
+        case NoiseOp::Voronoi: v.s = chain(voronoiNoiseD(a.q, s.edgeSharpness * n.value, s.scale * n.value2, s.seed), a); break;
+        case NoiseOp::Dunes: v.s = chain(sandDunesD(a.q, s.edgeSharpness, s.scale), a); break;
+        case NoiseOp::Add: v.s = a.s + b.s; break;
+        case NoiseOp::Mul:
+            v.s = glm::vec3(a.s.x * b.s.x, glm::vec2(a.s.y, a.s.z) * b.s.x + a.s.x * glm::vec2(b.s.y, b.s.z));
+            break;
+        }
+        values[i] = v;
+    }
+    return values[graph.output].s;
+}
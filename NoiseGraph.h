@@ -0,0 +1,85 @@
+#ifndef NOISE_GRAPH_H
+#define NOISE_GRAPH_H
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "TerrainTypes.h"
+
+// Datovy popis vysky biomu jako graf sumovych uzlu. Uzly jsou v poradi vytvoreni (vstupy maji vzdy mensi
+// index), hodnota uzlu je skalar nebo souradnice vec2. Derivace podle pos se propaguji dopredne, takze
+// z grafu vznikne float name(vec2 pos) i vec3 nameD(vec2 pos) jako u combinedNoise/combinedNoiseD.
+enum class NoiseOp {
+    Constant, // skalar value
+    Param,    // skalar z UBO: pole field bloku Params biomu biome (ID jako v Terrain.comp)
+    Position, // souradnice pos
+    Scale,    // souradnice a * skalar b
+    Warp,     // souradnice a + (fbm(b), fbm(b + (4.3, 2.1))) * value + fbm(b) * value2 (warp morphed Voronoi)
+    Fbm,      // fbm(a)
+    Ridge,    // ridgeNoise(a)
+    Voronoi,  // voronoiNoise(a, edgeSharpness * value, scale * value2)
+    Dunes,    // sandDunes(a)
+    Add,      // a + b
+    Mul       // a * b
+};
+
+// Poradi poli Params (bez enabled)
+enum NoiseParamField {
+    FIELD_FBM_FREQ, FIELD_FBM_AMP, FIELD_RIDGE_FREQ, FIELD_RIDGE_AMP, FIELD_VORO_FREQ, FIELD_VORO_AMP,
+    FIELD_MORPHED_FREQ, FIELD_MORPHED_AMP, FIELD_SAND_FREQ, FIELD_SAND_AMP, FIELD_COUNT
+};
+
+struct NoiseNode {
+    NoiseOp op;
+    int a = -1, b = -1;
+    float value = 0.0f, value2 = 0.0f;
+    int biome = 0, field = 0;
+};
+
+class NoiseGraph {
+public:
+    int Constant(float value);
+    int Param(int biome, int field);
+    int Position();
+    int Scale(int coord, int factor);
+    int Warp(int coord, int source, float strength = 2.0f, float distortion = 0.5f);
+    int Fbm(int coord);
+    int Ridge(int coord);
+    int Voronoi(int coord, float sharpness, float baseScale);
+    int Dunes(int coord);
+    int Add(int a, int b);
+    int Mul(int a, int b);
+
+    bool IsCoord(int node) const;
+    bool Empty() const { return output < 0; }
+
+    std::vector<NoiseNode> nodes;
+    int output = -1; // -1 = prazdny graf (biom pouziva combinedNoise)
+
+private:
+    int Push(const NoiseNode& node);
+};
+
+// Graf se stejnym vysledkem jako combinedNoise biomu biomeID, jen cleny s nenulovou amplitudou v params
+// (frekvence a amplitudy se ctou z UBO, takze posuvniky v GUI graf nemeni)
+NoiseGraph BiomeNoiseGraph(int biomeID, const Params& params);
+
+// Textovy popis: radky "jmeno = op argumenty", # uvozuje komentar, vystupem je posledni radek.
+// Operace: pos, const v, param <biom> <pole>, scale c f, warp c src [sila distortion], fbm c, ridge c,
+// voronoi c ostrost meritko, dunes c, add a b, mul a b. Cislo na miste uzlu je konstanta.
+// Pri chybe vraci false a popis v error.
+bool ParseNoiseGraph(const std::string& text, NoiseGraph& graph, std::string& error);
+bool LoadNoiseGraph(const std::string& path, NoiseGraph& graph, std::string& error);
+
+// Skladani konstant, slouceni shodnych uzlu a odstraneni uzlu, na kterych vystup nezavisi
+NoiseGraph CompileNoiseGraph(const NoiseGraph& graph);
+
+// GLSL pro Terrain.comp: #define NOISE_GRAPH_CODE s funkcemi graphBiomeNoise(id, pos) a graphBiomeNoiseD(id, pos).
+// graphs[id] jsou zkompilovane grafy biomu podle ID (Sea = 0 se nepouziva), prazdny graf vraci 0.
+std::string EmitNoiseGraphsGLSL(const NoiseGraph graphs[4]);
+
+// Interpret zkompilovaneho grafu pro CPU backend, stejne poradi operaci jako vygenerovany GLSL
+float EvaluateNoiseGraph(const NoiseGraph& graph, glm::vec2 pos, const TerrainSettings& s, const Uniforms& u);
+glm::vec3 EvaluateNoiseGraphD(const NoiseGraph& graph, glm::vec2 pos, const TerrainSettings& s, const Uniforms& u);
+
+#endif // NOISE_GRAPH_H
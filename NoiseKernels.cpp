@@ -0,0 +1,136 @@
+#include "NoiseKernels.h"
+#include "TerrainCPU.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if NOISE_KERNELS_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// Referencni skalarni verze - primo funkce CPU backendu
+static void PerlinScalar(const float* x, const float* y, float* out, int count, unsigned int seed) {
+    for (int i = 0; i < count; i++)
+        out[i] = perlinNoise(glm::vec2(x[i], y[i]), seed);
+}
+
+static void SimplexScalar(const float* x, const float* y, float* out, int count, unsigned int seed) {
+    for (int i = 0; i < count; i++)
+        out[i] = simplexNoise(glm::vec2(x[i], y[i]), seed);
+}
+
+static void Voronoi3Scalar(const float* x, const float* y, float* out, int count, unsigned int seed) {
+    for (int i = 0; i < count; i++) {
+        glm::vec3 mins[3], weights;
+        voronoiMap(glm::vec2(x[i], y[i]), 0.0f, 1.0f, seed, mins[0], mins[1], mins[2], weights);
+        for (int k = 0; k < 3; k++) {
+            out[size_t(3 * k + 0) * count + i] = mins[k].x;
+            out[size_t(3 * k + 1) * count + i] = mins[k].y;
+            out[size_t(3 * k + 2) * count + i] = mins[k].z;
+        }
+    }
+}
+
+static void SandDunesScalar(const float* x, const float* y, float* out, int count, float baseScale) {
+    for (int i = 0; i < count; i++)
+        out[i] = sandDunes(glm::vec2(x[i], y[i]), 0.0f, baseScale);
+}
+
+static const NoiseKernels scalarKernels = { NoiseISA::Scalar, "Scalar", 1, PerlinScalar, SimplexScalar, Voronoi3Scalar, SandDunesScalar };
+
+#if NOISE_KERNELS_X86
+static void Cpuid(int regs[4], int leaf, int subleaf) {
+#if defined(_MSC_VER)
+    __cpuidex(regs, leaf, subleaf);
+#else
+    unsigned int a, b, c, d;
+    __cpuid_count(leaf, subleaf, a, b, c, d);
+    regs[0] = int(a); regs[1] = int(b); regs[2] = int(c); regs[3] = int(d);
+#endif
+}
+
+static unsigned long long Xgetbv0() {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned int lo, hi;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return (static_cast<unsigned long long>(hi) << 32) | lo;
+#endif
+}
+#endif
+
+bool IsNoiseISASupported(NoiseISA isa) {
+    if (isa == NoiseISA::Scalar)
+        return true;
+#if NOISE_KERNELS_X86
+    int regs[4];
+    Cpuid(regs, 0, 0);
+    int maxLeaf = regs[0];
+    Cpuid(regs, 1, 0);
+    bool sse42 = (regs[2] & (1 << 20)) != 0;
+    bool osxsave = (regs[2] & (1 << 27)) != 0;
+    bool avx = (regs[2] & (1 << 28)) != 0;
+    bool fma = (regs[2] & (1 << 12)) != 0;
+    // OS musi ukladat YMM (bity 1, 2) resp. i ZMM/opmask stav (bity 5-7)
+    unsigned long long xcr0 = osxsave ? Xgetbv0() : 0;
+    bool ymmState = (xcr0 & 0x6) == 0x6;
+    bool zmmState = (xcr0 & 0xE6) == 0xE6;
+    bool avx2 = false, avx512f = false;
+    if (maxLeaf >= 7) {
+        Cpuid(regs, 7, 0);
+        avx2 = (regs[1] & (1 << 5)) != 0;
+        avx512f = (regs[1] & (1 << 16)) != 0;
+    }
+
+    switch (isa) {
+    case NoiseISA::SSE42: return sse42;
+    case NoiseISA::AVX2: return avx && avx2 && fma && ymmState;
+    case NoiseISA::AVX512: return avx512f && zmmState;
+    default: return false;
+    }
+#else
+    return false;
+#endif
+}
+
+const NoiseKernels* GetNoiseKernels(NoiseISA isa) {
+    if (!IsNoiseISASupported(isa))
+        return nullptr;
+    switch (isa) {
+    case NoiseISA::Scalar: return &scalarKernels;
+    case NoiseISA::SSE42: return GetNoiseKernelsSSE42();
+    case NoiseISA::AVX2: return GetNoiseKernelsAVX2();
+    case NoiseISA::AVX512: return GetNoiseKernelsAVX512();
+    default: return nullptr;
+    }
+}
+
+static const NoiseKernels& SelectNoiseKernels() {
+    const char* forced = std::getenv("TERRASHADE_NOISE_ISA");
+    if (forced) {
+        const char* names[] = { "scalar", "sse42", "avx2", "avx512" };
+        for (int i = 0; i < int(NoiseISA::Count); i++) {
+            if (std::strcmp(forced, names[i]) != 0)
+                continue;
+            if (const NoiseKernels* kernels = GetNoiseKernels(NoiseISA(i)))
+                return *kernels;
+            std::cerr << "TERRASHADE_NOISE_ISA=" << forced << " neni na tomto CPU podporovano\n";
+        }
+    }
+
+    for (int i = int(NoiseISA::Count) - 1; i > 0; i--) {
+        if (const NoiseKernels* kernels = GetNoiseKernels(NoiseISA(i)))
+            return *kernels;
+    }
+    return scalarKernels;
+}
+
+const NoiseKernels& GetNoiseKernels() {
+    static const NoiseKernels& kernels = SelectNoiseKernels();
+    return kernels;
+}
@@ -0,0 +1,59 @@
+#ifndef NOISE_KERNELS_H
+#define NOISE_KERNELS_H
+
+// Davkove (SIMD) verze sumovych primitiv z Terrain.comp.
+// Kazde volani zpracuje count vzorku, uvnitr po lanes pozicich najednou: SSE4.2 ma jen 128bitove registry,
+// tedy 4 drahy; 8 drah dava AVX2 a 16 AVX-512.
+//
+// TerrainCPU::GenerateTile pouziva voronoi3 pro body biomove mapy. Perlin, simplex a duny zustavaji
+// po texelech - GenerateTile potrebuje analyticke derivace (*D varianty) a parametry podle biomu texelu,
+// ktere kernely nemaji; samostatne se meri v TerrashadeBench.
+// Implementace se vybira pri startu podle CPUID (lze vynutit promennou TERRASHADE_NOISE_ISA=scalar|sse42|avx2|avx512).
+//
+// Vysledky sedi se skalarni verzi (TerrainCPU) bitove, hash bunek Voronoi i dun je celociselny (pcg2d).
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define NOISE_KERNELS_X86 1
+#else
+#define NOISE_KERNELS_X86 0
+#endif
+
+enum class NoiseISA {
+    Scalar,
+    SSE42,
+    AVX2,
+    AVX512,
+    Count
+};
+
+// Vystup voronoi3: 9 rovin po count prvcich - (x, y, vzdalenost^2) pro 1., 2. a 3. nejblizsi bod,
+// tj. stejne jako first_min/second_min/third_min ve voronoiMap. Pozice jsou uz v prostoru bunek (pos / scale).
+enum VoronoiPlane {
+    VORONOI_X1, VORONOI_Y1, VORONOI_F1,
+    VORONOI_X2, VORONOI_Y2, VORONOI_F2,
+    VORONOI_X3, VORONOI_Y3, VORONOI_F3,
+    VORONOI_PLANES
+};
+
+struct NoiseKernels {
+    NoiseISA isa;
+    const char* name;
+    int lanes;
+    void (*perlin)(const float* x, const float* y, float* out, int count, unsigned int seed);
+    void (*simplex)(const float* x, const float* y, float* out, int count, unsigned int seed);
+    void (*voronoi3)(const float* x, const float* y, float* out, int count, unsigned int seed);
+    void (*sandDunes)(const float* x, const float* y, float* out, int count, float baseScale);
+};
+
+// Nejlepsi podporovana implementace (vybrana jednou pri prvnim volani)
+const NoiseKernels& GetNoiseKernels();
+// Konkretni implementace, nullptr pokud ji CPU nebo build nepodporuje
+const NoiseKernels* GetNoiseKernels(NoiseISA isa);
+bool IsNoiseISASupported(NoiseISA isa);
+
+// Tabulky jednotlivych prekladovych jednotek (kazda preklada s vlastnimi prepinaci instrukci)
+const NoiseKernels* GetNoiseKernelsSSE42();
+const NoiseKernels* GetNoiseKernelsAVX2();
+const NoiseKernels* GetNoiseKernelsAVX512();
+
+#endif // NOISE_KERNELS_H
@@ -0,0 +1,62 @@
+#include <cstddef>
+#include "NoiseKernels.h"
+
+#if NOISE_KERNELS_X86
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC target("avx2,fma")
+// Bez slucovani do FMA - vzdalenosti k bodum bunek musi byt zaokrouhleny stejne jako ve skalarni verzi
+#pragma GCC optimize("fp-contract=off")
+#endif
+#include <immintrin.h>
+
+namespace {
+
+constexpr int W = 8;
+
+struct VF { __m256 v; };
+struct VI { __m256i v; };
+struct VM { __m256i v; };
+
+inline VF Set(float f) { return { _mm256_set1_ps(f) }; }
+inline VI SetI(int i) { return { _mm256_set1_epi32(i) }; }
+inline VF Load(const float* p) { return { _mm256_loadu_ps(p) }; }
+inline void Store(float* p, VF a) { _mm256_storeu_ps(p, a.v); }
+
+inline VF operator+(VF a, VF b) { return { _mm256_add_ps(a.v, b.v) }; }
+inline VF operator-(VF a, VF b) { return { _mm256_sub_ps(a.v, b.v) }; }
+inline VF operator*(VF a, VF b) { return { _mm256_mul_ps(a.v, b.v) }; }
+inline VF operator/(VF a, VF b) { return { _mm256_div_ps(a.v, b.v) }; }
+inline VF Min(VF a, VF b) { return { _mm256_min_ps(a.v, b.v) }; }
+inline VF Max(VF a, VF b) { return { _mm256_max_ps(a.v, b.v) }; }
+inline VF Floor(VF a) { return { _mm256_floor_ps(a.v) }; }
+inline VF Sqrt(VF a) { return { _mm256_sqrt_ps(a.v) }; }
+inline VI ToInt(VF a) { return { _mm256_cvttps_epi32(a.v) }; }
+inline VF ToFloat(VI a) { return { _mm256_cvtepi32_ps(a.v) }; }
+
+inline VI operator+(VI a, VI b) { return { _mm256_add_epi32(a.v, b.v) }; }
+inline VI operator*(VI a, VI b) { return { _mm256_mullo_epi32(a.v, b.v) }; }
+inline VI operator^(VI a, VI b) { return { _mm256_xor_si256(a.v, b.v) }; }
+inline VI operator&(VI a, VI b) { return { _mm256_and_si256(a.v, b.v) }; }
+template <int N> inline VI ShiftLeft(VI a) { return { _mm256_slli_epi32(a.v, N) }; }
+template <int N> inline VI ShiftRight(VI a) { return { _mm256_srli_epi32(a.v, N) }; }
+
+inline VM Less(VF a, VF b) { return { _mm256_castps_si256(_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)) }; }
+inline VM Greater(VF a, VF b) { return { _mm256_castps_si256(_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ)) }; }
+inline VM LessI(VI a, VI b) { return { _mm256_cmpgt_epi32(b.v, a.v) }; }
+inline VM EqI(VI a, VI b) { return { _mm256_cmpeq_epi32(a.v, b.v) }; }
+inline VM And(VM a, VM b) { return { _mm256_and_si256(a.v, b.v) }; }
+inline VF Select(VM m, VF a, VF b) { return { _mm256_blendv_ps(b.v, a.v, _mm256_castsi256_ps(m.v)) }; }
+
+#include "NoiseKernelsImpl.h"
+
+}
+
+const NoiseKernels* GetNoiseKernelsAVX2() {
+    static const NoiseKernels kernels = { NoiseISA::AVX2, "AVX2", W, PerlinBatch, SimplexBatch, Voronoi3Batch, SandDunesBatch };
+    return &kernels;
+}
+#else
+const NoiseKernels* GetNoiseKernelsAVX2() {
+    return nullptr;
+}
+#endif
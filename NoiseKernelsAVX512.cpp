@@ -0,0 +1,62 @@
+#include <cstddef>
+#include "NoiseKernels.h"
+
+#if NOISE_KERNELS_X86
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC target("avx512f")
+// Bez slucovani do FMA - vzdalenosti k bodum bunek musi byt zaokrouhleny stejne jako ve skalarni verzi
+#pragma GCC optimize("fp-contract=off")
+#endif
+#include <immintrin.h>
+
+namespace {
+
+constexpr int W = 16;
+
+struct VF { __m512 v; };
+struct VI { __m512i v; };
+struct VM { __mmask16 v; };
+
+inline VF Set(float f) { return { _mm512_set1_ps(f) }; }
+inline VI SetI(int i) { return { _mm512_set1_epi32(i) }; }
+inline VF Load(const float* p) { return { _mm512_loadu_ps(p) }; }
+inline void Store(float* p, VF a) { _mm512_storeu_ps(p, a.v); }
+
+inline VF operator+(VF a, VF b) { return { _mm512_add_ps(a.v, b.v) }; }
+inline VF operator-(VF a, VF b) { return { _mm512_sub_ps(a.v, b.v) }; }
+inline VF operator*(VF a, VF b) { return { _mm512_mul_ps(a.v, b.v) }; }
+inline VF operator/(VF a, VF b) { return { _mm512_div_ps(a.v, b.v) }; }
+inline VF Min(VF a, VF b) { return { _mm512_min_ps(a.v, b.v) }; }
+inline VF Max(VF a, VF b) { return { _mm512_max_ps(a.v, b.v) }; }
+inline VF Floor(VF a) { return { _mm512_roundscale_ps(a.v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC) }; }
+inline VF Sqrt(VF a) { return { _mm512_sqrt_ps(a.v) }; }
+inline VI ToInt(VF a) { return { _mm512_cvttps_epi32(a.v) }; }
+inline VF ToFloat(VI a) { return { _mm512_cvtepi32_ps(a.v) }; }
+
+inline VI operator+(VI a, VI b) { return { _mm512_add_epi32(a.v, b.v) }; }
+inline VI operator*(VI a, VI b) { return { _mm512_mullo_epi32(a.v, b.v) }; }
+inline VI operator^(VI a, VI b) { return { _mm512_xor_si512(a.v, b.v) }; }
+inline VI operator&(VI a, VI b) { return { _mm512_and_si512(a.v, b.v) }; }
+template <int N> inline VI ShiftLeft(VI a) { return { _mm512_slli_epi32(a.v, N) }; }
+template <int N> inline VI ShiftRight(VI a) { return { _mm512_srli_epi32(a.v, N) }; }
+
+inline VM Less(VF a, VF b) { return { _mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ) }; }
+inline VM Greater(VF a, VF b) { return { _mm512_cmp_ps_mask(a.v, b.v, _CMP_GT_OQ) }; }
+inline VM LessI(VI a, VI b) { return { _mm512_cmplt_epi32_mask(a.v, b.v) }; }
+inline VM EqI(VI a, VI b) { return { _mm512_cmpeq_epi32_mask(a.v, b.v) }; }
+inline VM And(VM a, VM b) { return { static_cast<__mmask16>(a.v & b.v) }; }
+inline VF Select(VM m, VF a, VF b) { return { _mm512_mask_blend_ps(m.v, b.v, a.v) }; }
+
+#include "NoiseKernelsImpl.h"
+
+}
+
+const NoiseKernels* GetNoiseKernelsAVX512() {
+    static const NoiseKernels kernels = { NoiseISA::AVX512, "AVX-512", W, PerlinBatch, SimplexBatch, Voronoi3Batch, SandDunesBatch };
+    return &kernels;
+}
+#else
+const NoiseKernels* GetNoiseKernelsAVX512() {
+    return nullptr;
+}
+#endif
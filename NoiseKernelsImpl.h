@@ -0,0 +1,230 @@
+// Spolecne telo SIMD kernelu - vklada se do NoiseKernelsSSE42/AVX2/AVX512.cpp az po definici
+// obalovych typu VF (float), VI (int32), VM (maska), sirky W a zakladnich operaci nad nimi.
+// Kod zrcadli Terrain.comp (perlinNoise, simplexNoise, hash(vec2), voronoiMap, sandDunes).
+
+static inline VF Fade(VF t) {
+    return t * t * t * (t * (t * Set(6.0f) - Set(15.0f)) + Set(10.0f));
+}
+
+static inline VF Lerp(VF a, VF b, VF t) {
+    return a + t * (b - a);
+}
+
+// int hash(int x, int y) - preteceni v int32 zalamuje stejne jako na GPU
+static inline VI HashI(VI x, VI y, VI seed) {
+    VI ux = (x + seed) ^ ShiftLeft<13>(x);
+    VI uy = (y + seed) ^ ShiftLeft<17>(y);
+    return ((ux * uy * SetI(15731) + SetI(789221)) ^ (ux + uy * SetI(1376312589))) & SetI(1023);
+}
+
+static inline VF Grad(VI hash, VF x, VF y) {
+    VI h = hash & SetI(7);
+    VF u = Select(LessI(h, SetI(4)), x, y);
+    VF v = Select(LessI(h, SetI(2)), y, x);
+    u = Select(EqI(h & SetI(1), SetI(0)), u, Set(0.0f) - u);
+    v = Select(EqI(h & SetI(2), SetI(0)), v, Set(0.0f) - v);
+    return u + v;
+}
+
+// dot(grad2(hash), (x, y)) bez tabulky - G = (1,1) (-1,1) (1,-1) (-1,-1) (1,0) (-1,0) (0,1) (0,-1)
+static inline VF Grad2Dot(VI hash, VF x, VF y) {
+    VI h = hash & SetI(7);
+    VM odd = EqI(h & SetI(1), SetI(1));
+    VF gx = Select(LessI(h, SetI(6)), Select(odd, Set(-1.0f), Set(1.0f)), Set(0.0f));
+    VF gyLow = Select(EqI(h & SetI(2), SetI(2)), Set(-1.0f), Set(1.0f));
+    VF gyHigh = Select(LessI(h, SetI(6)), Set(0.0f), Select(odd, Set(-1.0f), Set(1.0f)));
+    VF gy = Select(LessI(h, SetI(4)), gyLow, gyHigh);
+    return gx * x + gy * y;
+}
+
+static inline VF PerlinV(VF x, VF y, VI seed) {
+    VF fx = Floor(x), fy = Floor(y);
+    VI cx = ToInt(fx), cy = ToInt(fy);
+    VF lx = x - fx, ly = y - fy;
+    VF u = Fade(lx), v = Fade(ly);
+    VI one = SetI(1);
+
+    VF n00 = Grad(HashI(cx, cy, seed), lx, ly);
+    VF n10 = Grad(HashI(cx + one, cy, seed), lx - Set(1.0f), ly);
+    VF n01 = Grad(HashI(cx, cy + one, seed), lx, ly - Set(1.0f));
+    VF n11 = Grad(HashI(cx + one, cy + one, seed), lx - Set(1.0f), ly - Set(1.0f));
+
+    return Lerp(Lerp(n00, n10, u), Lerp(n01, n11, u), v);
+}
+
+static inline VF SimplexV(VF x, VF y, VI seed) {
+    const VF F2 = Set(0.36602540378f);
+    const VF G2 = Set(0.2113248654f);
+
+    VF s = x * F2 + y * F2;
+    VF ix = Floor(x + s), iy = Floor(y + s);
+    VF t = ix * G2 + iy * G2;
+    VF x0 = x - (ix - t), y0 = y - (iy - t);
+
+    VM xFirst = Greater(x0, y0);
+    VF i1x = Select(xFirst, Set(1.0f), Set(0.0f));
+    VF i1y = Select(xFirst, Set(0.0f), Set(1.0f));
+    VF x1 = x0 - i1x + G2, y1 = y0 - i1y + G2;
+    VF x2 = x0 - Set(1.0f) + Set(2.0f * 0.2113248654f), y2 = y0 - Set(1.0f) + Set(2.0f * 0.2113248654f);
+
+    VI h0 = HashI(ToInt(ix), ToInt(iy), seed);
+    VI h1 = HashI(ToInt(ix + i1x), ToInt(iy + i1y), seed);
+    VI h2 = HashI(ToInt(ix + Set(1.0f)), ToInt(iy + Set(1.0f)), seed);
+
+    VF t0 = Max(Set(0.5f) - (x0 * x0 + y0 * y0), Set(0.0f));
+    VF t1 = Max(Set(0.5f) - (x1 * x1 + y1 * y1), Set(0.0f));
+    VF t2 = Max(Set(0.5f) - (x2 * x2 + y2 * y2), Set(0.0f));
+    t0 = t0 * t0; t0 = t0 * t0;
+    t1 = t1 * t1; t1 = t1 * t1;
+    t2 = t2 * t2; t2 = t2 * t2;
+
+    return Set(70.0f) * (t0 * Grad2Dot(h0, x0, y0) + t1 * Grad2Dot(h1, x1, y1) + t2 * Grad2Dot(h2, x2, y2));
+}
+
+// pcg2d z Terrain.comp, 32bitove nasobeni a posuny zalamuji stejne jako uint na GPU
+static inline void Pcg2D(VI& x, VI& y) {
+    const VI m = SetI(1664525);
+    x = x * m + SetI(1013904223);
+    y = y * m + SetI(1013904223);
+    x = x + y * m;
+    y = y + x * m;
+    x = x ^ ShiftRight<16>(x);
+    y = y ^ ShiftRight<16>(y);
+    x = x + y * m;
+    y = y + x * m;
+    x = x ^ ShiftRight<16>(x);
+    y = y ^ ShiftRight<16>(y);
+}
+
+// Hornich 24 bitu do [0, 1), prevod je presny (< 2^24 se vejde do int i float)
+static inline VF UnitHash(VI h) {
+    return ToFloat(ShiftRight<8>(h)) * Set(1.0f / 16777216.0f);
+}
+
+// vec2 hash(vec2 p) se seedem z Terrain.comp (px, py jsou celociselne bunky)
+static inline void HashV2(VF px, VF py, VI seed, VF& hx, VF& hy) {
+    VI x = ToInt(px) + seed;
+    VI y = ToInt(py) + seed + seed;
+    Pcg2D(x, y);
+    hx = UnitHash(x);
+    hy = UnitHash(y);
+}
+
+static inline void Voronoi3V(VF x, VF y, VI seed, VF out[VORONOI_PLANES]) {
+    VF cellX = Floor(x), cellY = Floor(y);
+    VF px[9], py[9], d[9];
+
+    for (int j = -1; j <= 1; j++) {
+        for (int i = -1; i <= 1; i++) {
+            VF cx = Set(float(i)) + cellX;
+            VF cy = Set(float(j)) + cellY;
+            VF hx, hy;
+            HashV2(cx, cy, seed, hx, hy);
+            int idx = 3 * (j + 1) + (i + 1);
+            px[idx] = cx + hx;
+            py[idx] = cy + hy;
+            VF ox = px[idx] - x, oy = py[idx] - y;
+            d[idx] = ox * ox + oy * oy;
+        }
+    }
+
+    // Tri pruchody jako ve voronoiMap (ostre nerovnosti => shodne vzdalenosti se preskakuji)
+    VF best[3][3];
+    for (int k = 0; k < 3; k++) {
+        best[k][0] = best[k][1] = best[k][2] = Set(1000.0f);
+    }
+    for (int k = 0; k < 3; k++) {
+        for (int i = 0; i < 9; i++) {
+            VM take = Less(d[i], best[k][2]);
+            if (k > 0)
+                take = And(take, Less(best[k - 1][2], d[i]));
+            best[k][0] = Select(take, px[i], best[k][0]);
+            best[k][1] = Select(take, py[i], best[k][1]);
+            best[k][2] = Select(take, d[i], best[k][2]);
+        }
+    }
+    for (int k = 0; k < 3; k++) {
+        out[3 * k + 0] = best[k][0];
+        out[3 * k + 1] = best[k][1];
+        out[3 * k + 2] = best[k][2];
+    }
+}
+
+static inline VF SandDunesV(VF x, VF y, float baseScale) {
+    // Deleni jako pos /= (baseScale / 3) ve skalarni verzi, nasobeni prevracenou hodnotou by se lisilo v ulp
+    VF scale = Set(baseScale / 3);
+    x = x / scale;
+    y = y / scale;
+    VF cellX = Floor(x), cellY = Floor(y);
+    VF posX = cellX + (x - cellX), posY = cellY + (y - cellY);
+    VF minDist = Set(10.0f);
+
+    for (int j = -1; j <= 1; j++) {
+        for (int i = -1; i <= 1; i++) {
+            VF nx = cellX + Set(float(i));
+            VF ny = cellY + Set(float(j));
+            VF jx, jy;
+            HashV2(nx, ny, SetI(0), jx, jy);
+            VF ox = nx + jx - posX, oy = ny + jy - posY;
+            minDist = Min(minDist, Sqrt(ox * ox + oy * oy));
+        }
+    }
+    return minDist;
+}
+
+// Prochazi vstup po W prvcich, zbytek dopocita v doplnene davce
+template <typename Kernel>
+static inline void ForEachBatch(const float* x, const float* y, int count, Kernel kernel) {
+    int i = 0;
+    for (; i + W <= count; i += W)
+        kernel(Load(x + i), Load(y + i), i, W);
+    if (i < count) {
+        alignas(64) float tx[W] = { 0 }, ty[W] = { 0 };
+        for (int k = 0; i + k < count; k++) {
+            tx[k] = x[i + k];
+            ty[k] = y[i + k];
+        }
+        kernel(Load(tx), Load(ty), i, count - i);
+    }
+}
+
+static inline void StoreN(float* out, VF v, int n) {
+    if (n == W) {
+        Store(out, v);
+        return;
+    }
+    alignas(64) float tmp[W];
+    Store(tmp, v);
+    for (int k = 0; k < n; k++)
+        out[k] = tmp[k];
+}
+
+static void PerlinBatch(const float* x, const float* y, float* out, int count, unsigned int seed) {
+    VI s = SetI(static_cast<int>(seed));
+    ForEachBatch(x, y, count, [&](VF vx, VF vy, int i, int n) {
+        StoreN(out + i, PerlinV(vx, vy, s), n);
+    });
+}
+
+static void SimplexBatch(const float* x, const float* y, float* out, int count, unsigned int seed) {
+    VI s = SetI(static_cast<int>(seed));
+    ForEachBatch(x, y, count, [&](VF vx, VF vy, int i, int n) {
+        StoreN(out + i, SimplexV(vx, vy, s), n);
+    });
+}
+
+static void Voronoi3Batch(const float* x, const float* y, float* out, int count, unsigned int seed) {
+    VI s = SetI(static_cast<int>(seed));
+    ForEachBatch(x, y, count, [&](VF vx, VF vy, int i, int n) {
+        VF planes[VORONOI_PLANES];
+        Voronoi3V(vx, vy, s, planes);
+        for (int p = 0; p < VORONOI_PLANES; p++)
+            StoreN(out + size_t(p) * count + i, planes[p], n);
+    });
+}
+
+static void SandDunesBatch(const float* x, const float* y, float* out, int count, float baseScale) {
+    ForEachBatch(x, y, count, [&](VF vx, VF vy, int i, int n) {
+        StoreN(out + i, SandDunesV(vx, vy, baseScale), n);
+    });
+}
@@ -0,0 +1,60 @@
+#include <cstddef>
+#include "NoiseKernels.h"
+
+#if NOISE_KERNELS_X86
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC target("sse4.2")
+#endif
+#include <immintrin.h>
+
+namespace {
+
+constexpr int W = 4;
+
+struct VF { __m128 v; };
+struct VI { __m128i v; };
+struct VM { __m128i v; };
+
+inline VF Set(float f) { return { _mm_set1_ps(f) }; }
+inline VI SetI(int i) { return { _mm_set1_epi32(i) }; }
+inline VF Load(const float* p) { return { _mm_loadu_ps(p) }; }
+inline void Store(float* p, VF a) { _mm_storeu_ps(p, a.v); }
+
+inline VF operator+(VF a, VF b) { return { _mm_add_ps(a.v, b.v) }; }
+inline VF operator-(VF a, VF b) { return { _mm_sub_ps(a.v, b.v) }; }
+inline VF operator*(VF a, VF b) { return { _mm_mul_ps(a.v, b.v) }; }
+inline VF operator/(VF a, VF b) { return { _mm_div_ps(a.v, b.v) }; }
+inline VF Min(VF a, VF b) { return { _mm_min_ps(a.v, b.v) }; }
+inline VF Max(VF a, VF b) { return { _mm_max_ps(a.v, b.v) }; }
+inline VF Floor(VF a) { return { _mm_floor_ps(a.v) }; }
+inline VF Sqrt(VF a) { return { _mm_sqrt_ps(a.v) }; }
+inline VI ToInt(VF a) { return { _mm_cvttps_epi32(a.v) }; }
+inline VF ToFloat(VI a) { return { _mm_cvtepi32_ps(a.v) }; }
+
+inline VI operator+(VI a, VI b) { return { _mm_add_epi32(a.v, b.v) }; }
+inline VI operator*(VI a, VI b) { return { _mm_mullo_epi32(a.v, b.v) }; }
+inline VI operator^(VI a, VI b) { return { _mm_xor_si128(a.v, b.v) }; }
+inline VI operator&(VI a, VI b) { return { _mm_and_si128(a.v, b.v) }; }
+template <int N> inline VI ShiftLeft(VI a) { return { _mm_slli_epi32(a.v, N) }; }
+template <int N> inline VI ShiftRight(VI a) { return { _mm_srli_epi32(a.v, N) }; }
+
+inline VM Less(VF a, VF b) { return { _mm_castps_si128(_mm_cmplt_ps(a.v, b.v)) }; }
+inline VM Greater(VF a, VF b) { return { _mm_castps_si128(_mm_cmpgt_ps(a.v, b.v)) }; }
+inline VM LessI(VI a, VI b) { return { _mm_cmplt_epi32(a.v, b.v) }; }
+inline VM EqI(VI a, VI b) { return { _mm_cmpeq_epi32(a.v, b.v) }; }
+inline VM And(VM a, VM b) { return { _mm_and_si128(a.v, b.v) }; }
+inline VF Select(VM m, VF a, VF b) { return { _mm_blendv_ps(b.v, a.v, _mm_castsi128_ps(m.v)) }; }
+
+#include "NoiseKernelsImpl.h"
+
+}
+
+const NoiseKernels* GetNoiseKernelsSSE42() {
+    static const NoiseKernels kernels = { NoiseISA::SSE42, "SSE4.2", W, PerlinBatch, SimplexBatch, Voronoi3Batch, SandDunesBatch };
+    return &kernels;
+}
+#else
+const NoiseKernels* GetNoiseKernelsSSE42() {
+    return nullptr;
+}
+#endif
@@ -41,23 +41,76 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath) {
 Shader::Shader(const char* computePath) {
     std::cout << "Loading Compute Shader: " << computePath << std::endl;
 
+    CompileCompute(LoadShaderSource(computePath), true);
+
+    std::cout << "Compute Shader Loaded Successfully!" << std::endl;
+}
+
+Shader::Shader(const char* computePath, const std::string& defines, bool waitForCompile) {
     std::string computeCode = LoadShaderSource(computePath);
+    // Definice musí být až za direktivou #version
+    size_t versionEnd = computeCode.find('\n');
+    computeCode.insert(versionEnd == std::string::npos ? computeCode.size() : versionEnd + 1, defines);
+
+    CompileCompute(computeCode, waitForCompile);
+}
+
+void Shader::CompileCompute(const std::string& computeCode, bool waitForCompile) {
     const char* cShaderCode = computeCode.c_str();
 
     unsigned int compute;
     compute = glCreateShader(GL_COMPUTE_SHADER);
     glShaderSource(compute, 1, &cShaderCode, NULL);
     glCompileShader(compute);
-    CheckCompileErrors(compute, "COMPUTE");
+    if (waitForCompile)
+        CheckCompileErrors(compute, "COMPUTE");
 
     ID = glCreateProgram();
     glAttachShader(ID, compute);
     glLinkProgram(ID);
-    CheckCompileErrors(ID, "PROGRAM");
 
+    // Shader objekt se smaže až po odpojení od programu, kompilaci to nepřeruší
     glDeleteShader(compute);
 
-    std::cout << "Compute Shader Loaded Successfully!" << std::endl;
+    finished = false;
+    if (waitForCompile)
+        IsReady();
+}
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+bool Shader::HasParallelCompile() {
+    static int supported = -1;
+    if (supported < 0) {
+        supported = 0;
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++) {
+            const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+            if (name && (std::string(name) == "GL_KHR_parallel_shader_compile" || std::string(name) == "GL_ARB_parallel_shader_compile"))
+                supported = 1;
+        }
+    }
+    return supported == 1;
+}
+
+bool Shader::IsReady() {
+    if (!finished) {
+        if (HasParallelCompile()) {
+            GLint done = 0;
+            glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &done);
+            if (!done)
+                return false;
+        }
+        GLint success = 0;
+        glGetProgramiv(ID, GL_LINK_STATUS, &success);
+        valid = success != 0;
+        CheckCompileErrors(ID, "PROGRAM");
+        finished = true;
+    }
+    return valid;
 }
 
 // Aktivuje shader
@@ -136,7 +189,7 @@ void Shader::SetFloat(const char* name, float value) {
 
 // Nastaví uniformní proměnnou int
 void Shader::SetInt(const char* name, int value) {
-    glUniform1f(glGetUniformLocation(ID, name), value);
+    glUniform1i(glGetUniformLocation(ID, name), value);
 }
 
 void Shader::SetUInt(const char* name, unsigned int value) {
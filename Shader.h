@@ -13,6 +13,15 @@ public:
     // Konstruktor načítá vertex a fragment shader ze souborů a sestaví program
     Shader(const char* vertexPath, const char* fragmentPath);
     Shader(const char* computePath);
+    // Compute shader s #define řádky vloženými za #version. Při waitForCompile = false se na výsledek
+    // nečeká (GL_KHR_parallel_shader_compile), stav se zjistí přes IsReady()
+    Shader(const char* computePath, const std::string& defines, bool waitForCompile = true);
+
+    // true, jakmile je program dokončený a úspěšně slinkovaný
+    bool IsReady();
+    // false, pokud kompilace/linkování selhalo
+    bool IsValid() const { return valid; }
+    static bool HasParallelCompile();
 
     // Aktivuje shader program
     void Use();
@@ -31,11 +40,15 @@ public:
 
 
 private:
+    bool finished = true;
+    bool valid = true;
+
     // Načte kód shaderu ze souboru
     std::string LoadShaderSource(const char* filePath);
 
     // Zkontroluje chyby při kompilaci a linkování shaderu
     void CheckCompileErrors(unsigned int shader, std::string type);
+    void CompileCompute(const std::string& computeCode, bool waitForCompile);
 };
 
 #endif
\ No newline at end of file
@@ -5,6 +5,8 @@ struct Output{
     vec4 normal;
     uint biomeIDs[3];
     float biomeWeight[3];
+    float waterAmount;
+    float sedimentAmount;
 };
 
 layout (std430, binding = 0) buffer Buffer {
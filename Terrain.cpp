@@ -1,14 +1,43 @@
 ﻿#include "Terrain.h"
+#include "ErosionCPU.h"
 #include <iostream>
+#include <algorithm>
+#include <cfloat>
+#include <filesystem>
+#include <fstream>
 #define PRECISION (1024 * 16)
 #define CHUNK 33
 #define CHUNK_FACES 32
+#define MAX_SHADER_VARIANTS 16
+#define LAYER_COUNT 15
+#define BIOME_CELL_SIZE 48 // BiomeCell v Terrain.comp (std430)
+#define FEATURE_CELL_SIZE 32 // FeatureCell v Terrain.comp (std430)
+#define BIOME_SAMPLE_SIZE 48 // BiomeSample v Terrain.comp (std430)
+#define MAX_FEATURE_EXTENT 512 // tabulka nejvys 1024 x 1024 bunek (32 MB)
+#define BAKE_TEXTURE_SIZE (64 * 16) // BAKE_PERIOD * BAKE_TEXELS_PER_CELL v Terrain.comp
+#define RESULT_MEMO_SETTLE_MS 500 // mezistavy pri tazeni slideru se do LRU neukladaji
+#define GALLERY_MAX 16 // gallerySeeds v Terrain.comp
+#define STREAM_MAX_LOADS 32 // chunku prstence nactenych z disku za snimek
+#define STREAM_LOOKAHEAD 1.5f // s - jak daleko dopredu se okno posouva ve smeru pohybu kamery
+#define LAZY_COARSE_STEP 8 // krok hrubeho zastupce linive generovanych chunku (deli CHUNK_FACES)
+#define EROSION_BATCH (1 << 16) // kapek v jedne davce Erosion.comp s DROPLET_BATCH
+
+// Bity clenu combinedNoise, musi sedet s TERM_* v Terrain.comp
+enum TerrainTerm : uint32_t {
+    TERM_FBM = 1,
+    TERM_VORONOI = 2,
+    TERM_MORPHED = 4,
+    TERM_RIDGE = 8,
+    TERM_SAND = 16
+};
 
 
 Terrain::Terrain(int gridSize, float worldSize) : worldSize(worldSize),
 computeShader("Shaders/Terrain.comp"), erosionShader("Shaders/Erosion.comp"), normalShader("Shaders/Normals.comp"),
-erosionApplyShader("Shaders/ErosionApply.comp") {
+erosionApplyShader("Shaders/ErosionApply.comp"), fillShader("Shaders/TerrainFill.comp") {
     this->gridSize = (gridSize + CHUNK - 1) / CHUNK * CHUNK;
+    glGenQueries(1, &generationQuery);
+    glGenQueries(1, &erosionQuery);
     GenerateTerrain();
     ComputeTerrain();
 }
@@ -24,6 +53,25 @@ Terrain::~Terrain() {
     glDeleteBuffers(1, &intsSSBO);
     glDeleteBuffers(1, &uniformBuffer);
     glDeleteBuffers(1, &chunkPosSSBO);
+    glDeleteQueries(1, &generationQuery);
+    glDeleteQueries(1, &erosionQuery);
+    for (auto& variant : shaderVariants)
+        glDeleteProgram(variant.second.program.ID);
+    glDeleteBuffers(1, &biomeMapSSBO);
+    glDeleteBuffers(1, &layerSSBO);
+    glDeleteBuffers(1, &featureSSBO);
+    glDeleteBuffers(1, &biomeSampleSSBO);
+    glDeleteBuffers(1, &tileHeightsSSBO);
+    glDeleteBuffers(1, &tileDeltasSSBO);
+    glDeleteBuffers(1, &brushSSBO);
+    glDeleteBuffers(1, &pipeFluxSSBO);
+    glDeleteBuffers(1, &pipeFlowSSBO);
+    ClearResultMemo();
+    glDeleteTextures(1, &galleryTex);
+    glDeleteTextures(1, &bakedPerlinTex);
+    glDeleteTextures(1, &bakedSimplexTex);
+    glDeleteBuffers(1, &streamSSBO);
+    glDeleteBuffers(3, streamEBO);
 }
 
 std::vector<unsigned int> GenerateTerrainIdxBuffer(int rows, int cols, int gridSize, int lodLevel) {
@@ -49,6 +97,7 @@ std::vector<unsigned int> GenerateTerrainIdxBuffer(int rows, int cols, int gridS
 
 void Terrain::GenerateTerrain() {
     int chunksNum = (gridSize + CHUNK - 1) / CHUNK;
+    chunkBufferCapacity = chunksNum * chunksNum;
     // SSBO pro pozice (x, y, z)
     glGenBuffers(1, &resultsSSBO);
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, resultsSSBO);
@@ -172,6 +221,8 @@ void Terrain::Draw(Shader terrain, glm::mat4 view, glm::mat4 projection, glm::ve
     glBindVertexArray(VAO);
     int chunksNum = (gridSize + CHUNK - 1) / CHUNK;
     float dx = gridSize / worldSize;
+    GLuint outputsSSBO = resultsSSBO;
+    GLuint lodEBO[3] = { EBOLOD1, EBOLOD2, EBOLOD4 };
 
 
     chunksToRender.clear();
@@ -179,44 +230,58 @@ void Terrain::Draw(Shader terrain, glm::mat4 view, glm::mat4 projection, glm::ve
     drawOffsets2.clear();
     drawOffsets4.clear();
 
-    for (int y = 0; y < chunksNum; y++) {
-        for (int x = 0; x < chunksNum; x++) {
-            float minX = x * CHUNK * dx - (gridSize * 0.5f) * dx;
-            float minY = -100;
-            float minZ = y * CHUNK * dx - (gridSize * 0.5f) * dx;
-            float maxX = (x + 1) * CHUNK * dx - (gridSize * 0.5f) * dx;
-            float maxY = 100;
-            float maxZ = (y + 1) * CHUNK * dx - (gridSize * 0.5f) * dx;
-            glm::vec2 center = glm::vec2((minX + maxX) / 2, (minZ + maxZ) / 2);
-            bool isIn = isInFrustum(glm::vec3(minX, minY, minZ), glm::vec3(maxX, maxY, maxZ), planes, CHUNK * dx);
-            //bool isIn = true;
-            int chunkOffset = (y * gridSize + x) * CHUNK_FACES;
-            ChunkDraw chunkDraw = { 0 };
-            chunkDraw.vertexOffset = chunkOffset;
-            chunkDraw.chunkX = x;
-            chunkDraw.chunkY = y;
-            if (isIn) {
-                // Vzdálenost pro LOD
-                float dist = glm::length(center - glm::vec2(cameraPos.x, cameraPos.z));
-                //float dist = 20;
-                int lod = 0;
-                if (dist > 400.0f) {
-                    lod = 4;
-                    drawOffsets4.push_back(chunkDraw);
-                }
-                else if (dist > 200.0f) {
-                    lod = 2;
-                    drawOffsets2.push_back(chunkDraw);
+    if (streamingEnabled) {
+        // Chunky prstence maji vlastni bloky CHUNK x CHUNK, Terrain.vert dostane CHUNK jako delku radku
+        CollectStreamingChunks(planes, cameraPos);
+        chunksNum = ringSize;
+        outputsSSBO = streamSSBO;
+        for (int i = 0; i < 3; i++)
+            lodEBO[i] = streamEBO[i];
+        terrain.Use();
+        terrain.SetUInt("gridSize", CHUNK);
+    }
+    else {
+        for (int y = 0; y < chunksNum; y++) {
+            for (int x = 0; x < chunksNum; x++) {
+                float minX = x * CHUNK * dx - (gridSize * 0.5f) * dx;
+                float minY = -100;
+                float minZ = y * CHUNK * dx - (gridSize * 0.5f) * dx;
+                float maxX = (x + 1) * CHUNK * dx - (gridSize * 0.5f) * dx;
+                float maxY = 100;
+                float maxZ = (y + 1) * CHUNK * dx - (gridSize * 0.5f) * dx;
+                glm::vec2 center = glm::vec2((minX + maxX) / 2, (minZ + maxZ) / 2);
+                bool isIn = isInFrustum(glm::vec3(minX, minY, minZ), glm::vec3(maxX, maxY, maxZ), planes, CHUNK * dx);
+                //bool isIn = true;
+                int chunkOffset = (y * gridSize + x) * CHUNK_FACES;
+                ChunkDraw chunkDraw = { 0 };
+                chunkDraw.vertexOffset = chunkOffset;
+                chunkDraw.chunkX = x;
+                chunkDraw.chunkY = y;
+                if (isIn) {
+                    // Vzdálenost pro LOD
+                    float dist = glm::length(center - glm::vec2(cameraPos.x, cameraPos.z));
+                    //float dist = 20;
+                    int lod = 0;
+                    if (dist > 400.0f) {
+                        lod = 4;
+                        drawOffsets4.push_back(chunkDraw);
+                    }
+                    else if (dist > 200.0f) {
+                        lod = 2;
+                        drawOffsets2.push_back(chunkDraw);
+                    }
+                    else {
+                        lod = 1;
+                        drawOffsets1.push_back(chunkDraw);
+                    }
+                    if (lazyPending && !chunkGenerated[y * lazyChunksX + x])
+                        lazyVisible.push_back({ dist, y * lazyChunksX + x });
+
+                    chunksToRender.push_back(lod);    // LOD úroveň
                 }
                 else {
-                    lod = 1;
-                    drawOffsets1.push_back(chunkDraw);
+                    chunksToRender.push_back(0);      // Nezáleží
                 }
-
-                chunksToRender.push_back(lod);    // LOD úroveň
-            }
-            else {
-                chunksToRender.push_back(0);      // Nezáleží
             }
         }
     }
@@ -228,26 +293,25 @@ void Terrain::Draw(Shader terrain, glm::mat4 view, glm::mat4 projection, glm::ve
 
     glNamedBufferSubData(drawOffsetSSBO1, 0, drawOffsets1.size() * sizeof(ChunkDraw), drawOffsets1.data());
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, drawOffsetSSBO1);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, resultsSSBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOLOD1);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, outputsSSBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, lodEBO[0]);
     glDrawElementsInstanced(GL_TRIANGLES, CHUNK_FACES * CHUNK_FACES * 6, GL_UNSIGNED_INT, 0, drawOffsets1.size());
 
     glNamedBufferSubData(drawOffsetSSBO2, 0, drawOffsets2.size() * sizeof(ChunkDraw), drawOffsets2.data());
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, drawOffsetSSBO2);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, resultsSSBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOLOD2);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, outputsSSBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, lodEBO[1]);
     glDrawElementsInstanced(GL_TRIANGLES, CHUNK_FACES * CHUNK_FACES / 4 * 6, GL_UNSIGNED_INT, 0, drawOffsets2.size());
 
     glNamedBufferSubData(drawOffsetSSBO4, 0, drawOffsets4.size() * sizeof(ChunkDraw), drawOffsets4.data());
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, drawOffsetSSBO4);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, resultsSSBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOLOD4);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, outputsSSBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, lodEBO[2]);
     glDrawElementsInstanced(GL_TRIANGLES, CHUNK_FACES * CHUNK_FACES / 16 * 6, GL_UNSIGNED_INT, 0, drawOffsets4.size());
 }
 
 
 void Terrain::ComputeTerrain() {
-    computeShader.Use();
     uniforms.Dunes = Params{ 0.0, 0.0,  // fbm
             0.0, 0.0,  // ridge
             0.0, 0.0,  // voronoi
@@ -273,16 +337,1168 @@ void Terrain::ComputeTerrain() {
         0.0, 0.0 };
 
     glNamedBufferSubData(uniformBuffer, 0, sizeof(uniforms), &uniforms);
-    glUniform1i(glGetUniformLocation(computeShader.ID, "gridSize"), gridSize);
+
+    DispatchTerrain(); // Vypocty
+
+    glUseProgram(0);
+}
+
+static uint32_t ActiveTerms(const Params& params) {
+    uint32_t terms = 0;
+    if (params.fbmAmp != 0.0f) terms |= TERM_FBM;
+    if (params.voroAmp != 0.0f) terms |= TERM_VORONOI;
+    if (params.morphedvoroAmp != 0.0f) terms |= TERM_MORPHED;
+    if (params.ridgeAmp != 0.0f) terms |= TERM_RIDGE;
+    if (params.sandAmp != 0.0f) terms |= TERM_SAND;
+    return terms;
+}
+
+// Bity 0-3 povolene biomy, od bitu 4 aktivni cleny po 5 bitech pro Plains, Mountains, Dunes
+static uint32_t BiomeKey(const Uniforms& uniforms) {
+    // Poradi podle ID biomu v Terrain.comp (Sea = 0, Plains = 1, Mountains = 2, Dunes = 3)
+    const Params* biomes[4] = { &uniforms.Sea, &uniforms.Plains, &uniforms.Mountains, &uniforms.Dunes };
+    uint32_t key = 0;
+    for (uint32_t id = 0; id < 4; id++) {
+        if (biomes[id]->enabled != 1)
+            continue;
+        key |= 1u << id;
+        // Sea ma vzdy konstantni vysku, jeho cleny se nepocitaji
+        if (id > 0)
+            key |= ActiveTerms(*biomes[id]) << (4 + 5 * (id - 1));
+    }
+    // Zadny povoleny biom => shader stejne generuje jen Sea
+    return key ? key : 1u;
+}
+
+uint64_t Terrain::VariantKey() {
+    uint32_t biomeKey = BiomeKey(uniforms);
+    if (!noiseGraphsEnabled)
+        return biomeKey;
+    UpdateNoiseGraphs(biomeKey);
+    return biomeKey | uint64_t(noiseGraphHash) << 32;
+}
+
+std::string Terrain::VariantDefines(uint64_t key) const {
+    const char* names[3] = { "TERMS_PLAINS", "TERMS_MOUNTAINS", "TERMS_DUNES" };
+    std::string defines = "#define BIOME_MASK " + std::to_string(key & 0xF) + "u\n";
+    for (uint32_t i = 0; i < 3; i++)
+        defines += std::string("#define ") + names[i] + " " + std::to_string((key >> (4 + 5 * i)) & 0x1F) + "u\n";
+    if (key >> 32)
+        defines += noiseGraphCode;
+    return defines;
+}
+
+void Terrain::SetBiomeMap(bool enabled, int step) {
+    biomeMapEnabled = enabled;
+    biomeMapStep = std::max(step, 1);
+    RequestGeneration();
+}
+
+// Vzorky pokryvaji texely 0 .. gridSize - 1 vcetne posledniho, aby interpolace nemusela extrapolovat
+void Terrain::DispatchBiomeMap() {
+    if (!biomeMapEnabled)
+        return;
+    if (!biomeShader)
+        biomeShader = std::make_unique<Shader>("Shaders/Terrain.comp", "#define BIOME_PASS\n");
+
+    int size = (gridSize - 1) / biomeMapStep + 2;
+    if (size != biomeMapSize) {
+        glDeleteBuffers(1, &biomeSampleSSBO);
+        glGenBuffers(1, &biomeSampleSSBO);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, biomeSampleSSBO);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, size_t(size) * size * BIOME_SAMPLE_SIZE, NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        biomeMapSize = size;
+    }
+    ApplyTerrainUniforms(*biomeShader);
+    biomeShader->SetInt("biomeMapStep", biomeMapStep);
+    biomeShader->SetInt("biomeMapSize", biomeMapSize);
+    glBindBufferBase(GL_UNIFORM_BUFFER, 2, uniformBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, biomeSampleSSBO);
+    glDispatchCompute((size + 15) / 16, (size + 15) / 16, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void Terrain::ApplyBiomeMap(Shader& shader) {
+    if (!biomeMapEnabled)
+        return;
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, biomeSampleSSBO);
+    shader.Use();
+    shader.SetInt("biomeMapStep", biomeMapStep);
+    shader.SetInt("biomeMapSize", biomeMapSize);
+}
+
+// Grafy se stavi jen pro povolene biomy, vychozi graf obsahuje jen cleny s nenulovou amplitudou (jako TERMS_*)
+void Terrain::UpdateNoiseGraphs(uint32_t biomeKey) {
+    if (biomeKey == noiseGraphBiomeKey)
+        return;
+    const Params* biomes[4] = { &uniforms.Sea, &uniforms.Plains, &uniforms.Mountains, &uniforms.Dunes };
+    for (int id = 1; id < 4; id++) {
+        if (!(biomeKey & (1u << id)))
+            compiledGraphs[id] = NoiseGraph();
+        else
+            compiledGraphs[id] = CompileNoiseGraph(customGraphs[id].Empty() ? BiomeNoiseGraph(id, *biomes[id]) : customGraphs[id]);
+    }
+    noiseGraphCode = EmitNoiseGraphsGLSL(compiledGraphs);
+    noiseGraphHash = uint32_t(std::hash<std::string>()(noiseGraphCode)) | 1u;
+    noiseGraphBiomeKey = biomeKey;
+}
+
+void Terrain::SetNoiseGraphs(bool enabled) {
+    noiseGraphsEnabled = enabled;
+    RequestGeneration();
+}
+
+void Terrain::SetBiomeGraph(int biomeID, const NoiseGraph& graph) {
+    if (biomeID < 1 || biomeID > 3)
+        return;
+    customGraphs[biomeID] = graph;
+    noiseGraphsEnabled = true;
+    noiseGraphBiomeKey = 0;
+
+    NoiseGraph custom[4];
+    bool any = false;
+    for (int id = 1; id < 4; id++) {
+        if (!customGraphs[id].Empty()) {
+            custom[id] = CompileNoiseGraph(customGraphs[id]);
+            any = true;
+        }
+    }
+    customGraphHash = any ? std::hash<std::string>()(EmitNoiseGraphsGLSL(custom)) | 1u : 0;
+    RequestGeneration();
+}
+
+uint64_t Terrain::ParamsHash() const {
+    uint64_t hash = HashTerrainParams(settings, uniforms);
+    hash = HashBiomeMap(hash, biomeMapEnabled, biomeMapStep);
+    return customGraphHash ? HashValue(hash, customGraphHash) : hash;
+}
+
+// Hotova varianta pro aktualni biomy, jinak obecny program (a varianta se zaradi ke kompilaci)
+Shader& Terrain::SelectTerrainProgram() {
+    uint64_t key = VariantKey();
+    auto it = shaderVariants.find(key);
+    // Vlastni graf nema ekvivalent v obecnem programu, varianta se proto kompiluje hned (blokujici)
+    if (HasCustomGraphs() && (it == shaderVariants.end() || !it->second.program.IsReady())) {
+        if (it != shaderVariants.end()) {
+            glDeleteProgram(it->second.program.ID);
+            shaderVariants.erase(it);
+        }
+        CompileVariant(key, true);
+        it = shaderVariants.find(key);
+    }
+    if (it == shaderVariants.end()) {
+        requestedVariant = key;
+        variantRequested = true;
+    }
+    else if (it->second.program.IsReady()) {
+        it->second.lastUsed = ++variantClock;
+        lastDispatchSpecialized = true;
+        return it->second.program;
+    }
+    lastDispatchSpecialized = false;
+    return computeShader;
+}
+
+// Uniformy se nastavuji pri kazdem dispatchi, protoze kazda varianta je samostatny program
+void Terrain::ApplyTerrainUniforms(Shader& shader) {
+    UpdateFeatureTable();
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, featureSSBO);
+    shader.Use();
+    shader.SetInt("featureExtent", featureTableEnabled ? featureExtent : 0);
+    shader.SetInt("biomeMapStep", 0);
+    if (settings.bakedNoise) {
+        UpdateBakedNoise();
+        glBindTextureUnit(6, bakedPerlinTex);
+        glBindTextureUnit(7, bakedSimplexTex);
+        shader.Use();
+    }
+    shader.SetInt("bakedNoise", settings.bakedNoise ? 1 : 0);
+    shader.SetFloat("bakedFootprint", worldSize / gridSize * 0.1f);
+    shader.SetFloat("scale", settings.scale);
+    shader.SetFloat("edgeSharpness", settings.edgeSharpness);
+    shader.SetFloat("heightScale", settings.heightScale);
+    shader.SetUInt("octaves", settings.octaves);
+    shader.SetFloat("persistence", settings.persistence);
+    shader.SetFloat("lacunarity", settings.lacunarity);
+    shader.SetUInt("seed", settings.seed);
+    shader.SetInt("gridSize", gridSize);
+    shader.SetFloat("gridDx", worldSize / gridSize);
+    shader.SetInt("analyticNormals", settings.analyticNormals ? 1 : 0);
+    // Vychozi plny dispatch, progresivni generovani si je prepise
+    shader.SetInt("sampleStep", 1);
+    shader.SetInt("skipStep", 0);
+    shader.SetInt("rowOffset", 0);
+    shader.SetInt("rowCount", gridSize);
+    shader.SetInt("columnCount", gridSize);
+    shader.SetUInt("outputOffset", 0);
+    glUniform2f(glGetUniformLocation(shader.ID, "worldOffset"), 0.0f, 0.0f);
+}
+
+void Terrain::SetFeatureTable(bool enabled) {
+    featureTableEnabled = enabled;
+    if (!enabled) {
+        glDeleteBuffers(1, &featureSSBO);
+        featureSSBO = 0;
+        featureExtent = 0;
+    }
+    RequestGeneration();
+}
+
+// Vsechny Voronoi cleny (mapa biomu, voronoiNoise, morphed Voronoi, sandDunes) na okraji pevne mrizky
+int Terrain::RequiredFeatureExtent() const {
+    float reach = 0.05f * worldSize + 1.0f; // |pos| na okraji mrizky (pos = svet * 0.1) + vzorky computeNormal
+    float cells = reach / settings.scale;
+    const Params* biomes[3] = { &uniforms.Plains, &uniforms.Mountains, &uniforms.Dunes };
+    for (const Params* p : biomes) {
+        cells = std::max(cells, reach * p->voroFreq / (settings.scale * 1.5f));
+        cells = std::max(cells, (reach * p->morphedvoroFreq + 4.0f) / (settings.scale * 1.2f)); // warp + distortion
+        cells = std::max(cells, reach * p->sandFreq / (settings.scale / 3.0f));
+    }
+    return std::min(MAX_FEATURE_EXTENT, int(std::ceil(cells)) + 2); // + okoli 3x3
+}
+
+// Tabulka zavisi jen na seedu, meritko urcuje potrebny rozsah - zmensovat ji neni treba
+void Terrain::UpdateFeatureTable() {
+    if (!featureTableEnabled)
+        return;
+    int extent = RequiredFeatureExtent();
+    if (featureExtent > 0 && featureSeed == settings.seed && extent <= featureExtent)
+        return;
+    extent = std::max(extent, featureExtent);
+    if (!featureShader)
+        featureShader = std::make_unique<Shader>("Shaders/Terrain.comp", "#define FEATURE_PASS\n");
+
+    int size = 2 * extent;
+    if (extent != featureExtent) {
+        glDeleteBuffers(1, &featureSSBO);
+        glGenBuffers(1, &featureSSBO);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, featureSSBO);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, size_t(size) * size * FEATURE_CELL_SIZE, NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, featureSSBO);
+    featureShader->Use();
+    featureShader->SetUInt("seed", settings.seed);
+    featureShader->SetInt("featureExtent", extent);
+    glDispatchCompute((size + 15) / 16, (size + 15) / 16, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    featureExtent = extent;
+    featureSeed = settings.seed;
+}
+
+void Terrain::SetBakedNoise(bool enabled) {
+    settings.bakedNoise = enabled;
+    RequestGeneration();
+}
+
+// Jedna oktava Perlin a simplex sumu (hodnota a derivace) do RGBA16F s mipmapami, textury se stavi jen jednou
+void Terrain::UpdateBakedNoise() {
+    if (bakedPerlinTex != 0 && bakedSeed == settings.seed)
+        return;
+    if (!bakeShader)
+        bakeShader = std::make_unique<Shader>("Shaders/Terrain.comp", "#define BAKE_PASS\n");
+
+    if (bakedPerlinTex == 0) {
+        int levels = int(std::log2(BAKE_TEXTURE_SIZE)) + 1;
+        GLuint textures[2];
+        glCreateTextures(GL_TEXTURE_2D, 2, textures);
+        for (GLuint texture : textures) {
+            glTextureStorage2D(texture, levels, GL_RGBA16F, BAKE_TEXTURE_SIZE, BAKE_TEXTURE_SIZE);
+            glTextureParameteri(texture, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTextureParameteri(texture, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        }
+        bakedPerlinTex = textures[0];
+        bakedSimplexTex = textures[1];
+    }
+    bakeShader->Use();
+    bakeShader->SetUInt("seed", settings.seed);
+    glBindImageTexture(0, bakedPerlinTex, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+    glBindImageTexture(1, bakedSimplexTex, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+    glDispatchCompute((BAKE_TEXTURE_SIZE + 15) / 16, (BAKE_TEXTURE_SIZE + 15) / 16, 1);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+    glGenerateTextureMipmap(bakedPerlinTex);
+    glGenerateTextureMipmap(bakedSimplexTex);
+    bakedSeed = settings.seed;
+}
+
+// Bez GL_KHR_parallel_shader_compile kompilace blokuje, proto se spousti nejvys jedna varianta za snimek
+void Terrain::PollShaderVariants() {
+    for (auto& variant : shaderVariants)
+        variant.second.program.IsReady();
+
+    if (!variantRequested)
+        return;
+    variantRequested = false;
+    if (shaderVariants.count(requestedVariant))
+        return;
+    // Grafy se od pozadavku zmenily, aktualni varianta se vyzada pri pristim dispatchi
+    if ((requestedVariant >> 32) != 0 && (requestedVariant >> 32) != noiseGraphHash)
+        return;
+    CompileVariant(requestedVariant, false);
+}
+
+void Terrain::CompileVariant(uint64_t key, bool waitForCompile) {
+    if (shaderVariants.size() >= MAX_SHADER_VARIANTS) {
+        auto oldest = shaderVariants.begin();
+        for (auto it = shaderVariants.begin(); it != shaderVariants.end(); ++it) {
+            if (it->second.lastUsed < oldest->second.lastUsed)
+                oldest = it;
+        }
+        glDeleteProgram(oldest->second.program.ID);
+        shaderVariants.erase(oldest);
+    }
+    Shader program("Shaders/Terrain.comp", VariantDefines(key), waitForCompile);
+    shaderVariants.emplace(key, ShaderVariant{ program, ++variantClock });
+}
+
+// Dispatch Terrain.comp (specializovana varianta nebo obecny program), doba se meri timer query
+void Terrain::DispatchTerrain() {
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, resultsSSBO);
     glBindBufferBase(GL_UNIFORM_BUFFER, 2, uniformBuffer);
 
-    glDispatchCompute((gridSize + 15) / 16, (gridSize + 15) / 16, 1); // Vypocty
+    PollGenerationQuery();
+    glBeginQuery(GL_TIME_ELAPSED, generationQuery);
+    if (layerCacheEnabled && !HasCustomGraphs()) {
+        DispatchLayerCache();
+        queryTexels = 0.0; // rekombinace nema cenu Terrain.comp
+    }
+    else {
+        DispatchBiomeMap();
+        Shader& program = SelectTerrainProgram();
+        ApplyTerrainUniforms(program);
+        ApplyBiomeMap(program);
+        glDispatchCompute((gridSize + 15) / 16, (gridSize + 15) / 16, 1);
+        queryTexels = double(gridSize) * gridSize;
+    }
     glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT); // Zápis do bufferu před čtením
+    glEndQuery(GL_TIME_ELAPSED);
+    generationQueryPending = true;
+    // Plny dispatch s aktualnimi parametry nahrazuje cekajici i rozpracovanou ulohu
+    generationRequested = false;
+    refineStep = 0;
+    lazyPending = false;
+    erosionBatch = erosionBatches = 0;
+    gridHistory = 0;
+    MarkGridChanged();
+}
+
+// Zmena parametru jen oznaci cekajici praci - vice zmen za snimek se slouci do jedne ulohy
+// a rozpracovana uloha se zrusi (jeste neodeslane pasy uz se nedispatchnou)
+void Terrain::RequestGeneration() {
+    if (streamingEnabled) {
+        // Chunky prstence se pregeneruji postupne v UpdateStreaming, pevna mrizka az po vypnuti
+        streamVersion++;
+        return;
+    }
+    generationRequested = true;
+    refineStep = 0;
+}
+
+void Terrain::SetStreaming(bool enabled, int ringSize) {
+    if (enabled == streamingEnabled)
+        return;
+    streamingEnabled = enabled;
+    if (!enabled) {
+        glDeleteBuffers(1, &streamSSBO);
+        glDeleteBuffers(3, streamEBO);
+        streamSSBO = 0;
+        streamEBO[0] = streamEBO[1] = streamEBO[2] = 0;
+        streamSlots.clear();
+        RequestGeneration(); // parametry se mezitim mohly zmenit
+        return;
+    }
+
+    this->ringSize = ringSize;
+    glGenBuffers(1, &streamSSBO);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, streamSSBO);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, size_t(ringSize) * ringSize * CHUNK * CHUNK * sizeof(Output), NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 
+    // Buffery pro LOD a seznamy kreslenych chunku musi pojmout cely prstenec
+    if (ringSize * ringSize > chunkBufferCapacity) {
+        chunkBufferCapacity = ringSize * ringSize;
+        glNamedBufferData(chunkPosSSBO, chunkBufferCapacity * sizeof(int), NULL, GL_DYNAMIC_DRAW);
+        glNamedBufferData(drawOffsetSSBO1, chunkBufferCapacity * sizeof(ChunkDraw), NULL, GL_DYNAMIC_DRAW);
+        glNamedBufferData(drawOffsetSSBO2, chunkBufferCapacity * sizeof(ChunkDraw), NULL, GL_DYNAMIC_DRAW);
+        glNamedBufferData(drawOffsetSSBO4, chunkBufferCapacity * sizeof(ChunkDraw), NULL, GL_DYNAMIC_DRAW);
+    }
+
+    glBindVertexArray(VAO);
+    glGenBuffers(3, streamEBO);
+    int lods[3] = { 1, 2, 4 };
+    for (int i = 0; i < 3; i++) {
+        std::vector<unsigned int> indices = GenerateTerrainIdxBuffer(CHUNK, CHUNK, CHUNK, lods[i]);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, streamEBO[i]);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    }
+    glBindVertexArray(0);
+
+    streamSlots.assign(size_t(ringSize) * ringSize, StreamSlot{ glm::ivec2(0), 0, false });
+    cameraVelocity = glm::vec2(0.0f);
+}
+
+void Terrain::UpdateStreaming(glm::vec3 cameraPos, float deltaTime) {
+    if (!streamingEnabled)
+        return;
+    glm::vec2 cameraXZ(cameraPos.x, cameraPos.z);
+    if (deltaTime > 0.0f)
+        cameraVelocity = glm::mix(cameraVelocity, (cameraXZ - lastCameraXZ) / deltaTime, 0.2f);
+    lastCameraXZ = cameraXZ;
+
+    // Chunk ma CHUNK_FACES ploch, sousedni chunky sdileji krajni radek texelu
+    float chunkWorld = CHUNK_FACES * worldSize / gridSize;
+    glm::vec2 lead = cameraVelocity * STREAM_LOOKAHEAD / chunkWorld;
+    float maxLead = ringSize / 4.0f;
+    if (glm::length(lead) > maxLead)
+        lead *= maxLead / glm::length(lead);
+    glm::vec2 cameraChunk = cameraXZ / chunkWorld;
+    glm::ivec2 center = glm::ivec2(glm::floor(cameraChunk + lead));
+    ringOrigin = center - glm::ivec2(ringSize / 2);
+
+    // Chunky okna, ktere ve svem slotu chybi nebo jsou ze starych parametru
+    struct Pending {
+        float priority;
+        int slot;
+        glm::ivec2 chunk;
+    };
+    std::vector<Pending> pending;
+    for (int y = 0; y < ringSize; y++) {
+        for (int x = 0; x < ringSize; x++) {
+            glm::ivec2 chunk = ringOrigin + glm::ivec2(x, y);
+            int slot = ((chunk.y % ringSize + ringSize) % ringSize) * ringSize + (chunk.x % ringSize + ringSize) % ringSize;
+            const StreamSlot& s = streamSlots[slot];
+            bool missing = !s.resident || s.chunk != chunk;
+            if (!missing && s.version == streamVersion)
+                continue;
+            // Chybejici chunky pred zastaralymi, pak podle vzdalenosti od kamery
+            float dist = glm::length(glm::vec2(chunk) + 0.5f - cameraChunk);
+            pending.push_back({ dist + (missing ? 0.0f : 1e6f), slot, chunk });
+        }
+    }
+    PollGenerationQuery();
+    if (!generationQueryPending)
+        FlushStreamStores();
+    if (pending.empty())
+        return;
+
+    std::sort(pending.begin(), pending.end(),
+        [](const Pending& a, const Pending& b) { return a.priority < b.priority; });
+
+    // Nejdriv chunky z diskove cache, ty GPU rozpocet nestoji
+    uint64_t paramsHash = ParamsHash();
+    std::vector<Output> chunkData(CHUNK * CHUNK);
+    int loads = 0;
+    if (chunkCache) {
+        for (size_t i = 0; i < pending.size() && loads < STREAM_MAX_LOADS; ) {
+            if (chunkCache->Load(StreamChunkKey(paramsHash, pending[i].chunk), chunkData.data(), chunkData.size() * sizeof(Output))) {
+                glNamedBufferSubData(streamSSBO, size_t(pending[i].slot) * CHUNK * CHUNK * sizeof(Output),
+                    chunkData.size() * sizeof(Output), chunkData.data());
+                streamSlots[pending[i].slot] = StreamSlot{ pending[i].chunk, streamVersion, true };
+                pending.erase(pending.begin() + i);
+                loads++;
+            }
+            else {
+                i++;
+            }
+        }
+    }
+
+    // GPU jeste nedokoncila chunky z minuleho snimku
+    if (generationQueryPending || pending.empty())
+        return;
+
+    int budgetChunks = std::max(1, int(frameBudgetMs / (CHUNK * CHUNK * msPerTexel)));
+    int count = std::min(budgetChunks, int(pending.size()));
+
+    Shader& program = SelectTerrainProgram();
+    ApplyTerrainUniforms(program);
+    program.SetInt("gridSize", CHUNK);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, streamSSBO);
+    glBindBufferBase(GL_UNIFORM_BUFFER, 2, uniformBuffer);
+
+    glBeginQuery(GL_TIME_ELAPSED, generationQuery);
+    for (int i = 0; i < count; i++) {
+        DispatchStreamChunk(program, pending[i].slot, pending[i].chunk);
+        if (chunkCache)
+            streamStoreQueue.push_back({ pending[i].slot, pending[i].chunk });
+    }
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    glEndQuery(GL_TIME_ELAPSED);
+    generationQueryPending = true;
+    queryTexels = double(count) * CHUNK * CHUNK;
     glUseProgram(0);
 }
 
+void Terrain::SetDiskCache(bool enabled, uint64_t maxBytes, bool resumeErosion) {
+    this->resumeErosion = resumeErosion;
+    if (!enabled) {
+        chunkCache.reset();
+        streamStoreQueue.clear();
+        gridStorePending = false;
+        return;
+    }
+    if (chunkCache)
+        chunkCache->SetMaxBytes(maxBytes);
+    else
+        chunkCache = std::make_unique<ChunkCache>("Cache", maxBytes);
+    MarkGridChanged(); // aktualni teren jeste nemusi byt v cache
+}
+
+uint64_t Terrain::GridKey(uint64_t history) const {
+    uint64_t key = ParamsHash();
+    key = HashValue(key, gridSize);
+    key = HashValue(key, worldSize);
+    return HashValue(key, history);
+}
+
+uint64_t Terrain::StreamChunkKey(uint64_t paramsHash, glm::ivec2 chunk) const {
+    uint64_t key = HashValue(paramsHash, worldSize / gridSize);
+    key = HashValue(key, chunk.x);
+    return HashValue(key, chunk.y);
+}
+
+// Pevna mrizka se uklada po radcich chunku (CHUNK radku texelu = souvisly usek resultsSSBO)
+bool Terrain::IsGridCached(uint64_t gridKey) const {
+    int chunkRows = (gridSize + CHUNK - 1) / CHUNK;
+    for (int row = 0; row < chunkRows; row++) {
+        if (!chunkCache->Contains(HashValue(gridKey, row)))
+            return false;
+    }
+    return true;
+}
+
+bool Terrain::LoadGridFromCache(uint64_t gridKey) {
+    if (!IsGridCached(gridKey))
+        return false;
+    int chunkRows = (gridSize + CHUNK - 1) / CHUNK;
+    std::vector<Output> rowData(size_t(CHUNK) * gridSize);
+    for (int row = 0; row < chunkRows; row++) {
+        size_t first = size_t(row) * CHUNK * gridSize;
+        size_t count = size_t(std::min(CHUNK, gridSize - row * CHUNK)) * gridSize;
+        // Poskozeny zaznam => zbytek se dogeneruje normalne
+        if (!chunkCache->Load(HashValue(gridKey, row), rowData.data(), count * sizeof(Output)))
+            return false;
+        glNamedBufferSubData(resultsSSBO, first * sizeof(Output), count * sizeof(Output), rowData.data());
+    }
+    gridStorePending = false;
+    return true;
+}
+
+// Cerstvy teren, pripadne posledni ulozeny erodovany stav (hlavicka = 8 B s historii)
+bool Terrain::LoadCachedTerrain() {
+    uint64_t base = GridKey(0);
+    uint64_t head = 0;
+    if (resumeErosion && chunkCache->Load(HashValue(base, 'H'), &head, sizeof(head)) && LoadGridFromCache(GridKey(head))) {
+        gridHistory = head;
+        return true;
+    }
+    if (!LoadGridFromCache(base))
+        return false;
+    gridHistory = 0;
+    return true;
+}
+
+void Terrain::StoreGridToCache() {
+    gridStorePending = false;
+    uint64_t gridKey = GridKey(gridHistory);
+    if (!IsGridCached(gridKey)) {
+        int chunkRows = (gridSize + CHUNK - 1) / CHUNK;
+        std::vector<Output> rowData(size_t(CHUNK) * gridSize);
+        for (int row = 0; row < chunkRows; row++) {
+            size_t first = size_t(row) * CHUNK * gridSize;
+            size_t count = size_t(std::min(CHUNK, gridSize - row * CHUNK)) * gridSize;
+            glGetNamedBufferSubData(resultsSSBO, first * sizeof(Output), count * sizeof(Output), rowData.data());
+            chunkCache->Store(HashValue(gridKey, row), rowData.data(), count * sizeof(Output));
+        }
+    }
+    if (gridHistory != 0)
+        chunkCache->Store(HashValue(GridKey(0), 'H'), &gridHistory, sizeof(gridHistory));
+}
+
+void Terrain::MarkGridChanged() {
+    gridStorePending = chunkCache != nullptr;
+    memoStorePending = memoBudgetBytes > 0 && gridHistory == 0; // erodovane a upravene stavy ne
+    gridChangedAt = std::chrono::steady_clock::now();
+}
+
+void Terrain::SetResultMemo(bool enabled, uint64_t budgetBytes) {
+    memoBudgetBytes = enabled ? budgetBytes : 0;
+    if (!enabled)
+        ClearResultMemo();
+    else
+        memoStorePending = refineStep == 0 && gridHistory == 0; // aktualni vysledek je hotovy
+    gridChangedAt = std::chrono::steady_clock::now();
+}
+
+void Terrain::ClearResultMemo() {
+    for (auto& entry : resultMemo)
+        glDeleteBuffers(1, &entry.second.buffer);
+    resultMemo.clear();
+    memoStorePending = false;
+}
+
+bool Terrain::LoadResultSnapshot() {
+    auto it = resultMemo.find(GridKey(0));
+    if (it == resultMemo.end())
+        return false;
+    glCopyNamedBufferSubData(it->second.buffer, resultsSSBO, 0, 0, size_t(gridSize) * gridSize * sizeof(Output));
+    it->second.lastUsed = ++memoClock;
+    gridHistory = 0;
+    memoStorePending = false;
+    return true;
+}
+
+// Snapshoty maji stejnou velikost, nad rozpoctem se proto recykluje buffer nejdele nepouziteho
+void Terrain::StoreResultSnapshot() {
+    memoStorePending = false;
+    uint64_t key = GridKey(0);
+    auto it = resultMemo.find(key);
+    if (it != resultMemo.end()) {
+        it->second.lastUsed = ++memoClock;
+        return;
+    }
+    size_t bytes = size_t(gridSize) * gridSize * sizeof(Output);
+    size_t capacity = size_t(memoBudgetBytes / bytes);
+    if (capacity == 0)
+        return;
+
+    GLuint buffer = 0;
+    while (resultMemo.size() >= capacity) {
+        auto lru = std::min_element(resultMemo.begin(), resultMemo.end(),
+            [](const auto& a, const auto& b) { return a.second.lastUsed < b.second.lastUsed; });
+        if (buffer != 0)
+            glDeleteBuffers(1, &buffer);
+        buffer = lru->second.buffer;
+        resultMemo.erase(lru);
+    }
+    if (buffer == 0) {
+        glCreateBuffers(1, &buffer);
+        glNamedBufferStorage(buffer, bytes, NULL, 0); // jen kopie na GPU
+    }
+    glCopyNamedBufferSubData(resultsSSBO, buffer, 0, 0, bytes);
+    resultMemo[key] = ResultSnapshot{ buffer, ++memoClock };
+}
+
+// Cte jen chunky, ktere GPU uz dopocitala (timer query z jejich snimku je hotova)
+void Terrain::FlushStreamStores() {
+    if (!chunkCache || streamStoreQueue.empty())
+        return;
+    uint64_t paramsHash = ParamsHash();
+    std::vector<Output> chunkData(CHUNK * CHUNK);
+    for (const auto& item : streamStoreQueue) {
+        const StreamSlot& s = streamSlots[item.first];
+        // Slot byl mezitim recyklovany nebo se zmenily parametry
+        if (!s.resident || s.chunk != item.second || s.version != streamVersion)
+            continue;
+        glGetNamedBufferSubData(streamSSBO, size_t(item.first) * CHUNK * CHUNK * sizeof(Output),
+            chunkData.size() * sizeof(Output), chunkData.data());
+        chunkCache->Store(StreamChunkKey(paramsHash, item.second), chunkData.data(), chunkData.size() * sizeof(Output));
+    }
+    streamStoreQueue.clear();
+}
+
+// Chunk (cx, cz) pokryva texely [cx * CHUNK_FACES, cx * CHUNK_FACES + CHUNK_FACES] nekonecne mrizky
+void Terrain::DispatchStreamChunk(Shader& program, int slot, glm::ivec2 chunk) {
+    float gridDx = worldSize / gridSize;
+    // Terrain.comp centruje blok kolem (CHUNK / 2, CHUNK / 2), worldOffset to vraci na roh chunku
+    glm::vec2 offset = (glm::vec2(chunk) * float(CHUNK_FACES) + CHUNK * 0.5f) * gridDx;
+    program.SetUInt("outputOffset", slot * CHUNK * CHUNK);
+    glUniform2f(glGetUniformLocation(program.ID, "worldOffset"), offset.x, offset.y);
+    glDispatchCompute((CHUNK + 15) / 16, (CHUNK + 15) / 16, 1);
+    streamSlots[slot] = StreamSlot{ chunk, streamVersion, true };
+}
+
+// Seznamy kreslenych chunku prstence - souradnice chunku jsou relativni k oknu, aby Terrain.vert
+// nasel sousedy pro navazani LOD stejne jako u pevne mrizky
+void Terrain::CollectStreamingChunks(glm::vec4 planes[6], glm::vec3 cameraPos) {
+    float chunkWorld = CHUNK_FACES * worldSize / gridSize;
+    for (int y = 0; y < ringSize; y++) {
+        for (int x = 0; x < ringSize; x++) {
+            glm::ivec2 chunk = ringOrigin + glm::ivec2(x, y);
+            int slot = ((chunk.y % ringSize + ringSize) % ringSize) * ringSize + (chunk.x % ringSize + ringSize) % ringSize;
+            const StreamSlot& s = streamSlots[slot];
+            glm::vec3 minCorner(chunk.x * chunkWorld, -100.0f, chunk.y * chunkWorld);
+            glm::vec3 maxCorner(minCorner.x + chunkWorld, 100.0f, minCorner.z + chunkWorld);
+            // Recyklovany slot muze jeste drzet chunk mimo okno, ten se nekresli
+            if (!s.resident || s.chunk != chunk || !isInFrustum(minCorner, maxCorner, planes, chunkWorld)) {
+                chunksToRender.push_back(0);
+                continue;
+            }
+            ChunkDraw chunkDraw = { slot * CHUNK * CHUNK, x, y };
+            glm::vec2 center(minCorner.x + chunkWorld * 0.5f, minCorner.z + chunkWorld * 0.5f);
+            float dist = glm::length(center - glm::vec2(cameraPos.x, cameraPos.z));
+            int lod = 1;
+            if (dist > 400.0f) {
+                lod = 4;
+                drawOffsets4.push_back(chunkDraw);
+            }
+            else if (dist > 200.0f) {
+                lod = 2;
+                drawOffsets2.push_back(chunkDraw);
+            }
+            else {
+                drawOffsets1.push_back(chunkDraw);
+            }
+            chunksToRender.push_back(lod);
+        }
+    }
+}
+
+// Zacatek ulohy s aktualnimi parametry
+void Terrain::StartGeneration() {
+    generationRequested = false;
+    refineStep = 0;
+    lazyPending = false;
+    erosionBatch = erosionBatches = 0; // rozpracovany krok eroze se zahodi s mrizkou
+    if (LoadResultSnapshot())
+        return;
+    if (chunkCache && LoadCachedTerrain())
+        return;
+    if (layerCacheEnabled && !HasCustomGraphs()) {
+        DispatchTerrain(); // rekombinace je levna, nedeli se
+        return;
+    }
+    if (lazyEnabled) {
+        gridHistory = 0;
+        DispatchBiomeMap();
+        StartLazyGeneration();
+        return;
+    }
+    // Krok nejhrubsi urovne patri k uloze, prepnuti rezimu behem ulohy ji nerozbije
+    jobCoarseStep = progressiveEnabled ? coarseStep : 1;
+    refineStep = jobCoarseStep;
+    refineChunkRow = 0;
+    gridHistory = 0;
+    DispatchBiomeMap();
+}
+
+void Terrain::SetProgressive(bool enabled, int coarseStep) {
+    progressiveEnabled = enabled;
+    // Kroky urovni se pulisi, proto mocnina dvou
+    this->coarseStep = 1;
+    while (this->coarseStep * 2 <= coarseStep)
+        this->coarseStep *= 2;
+}
+
+void Terrain::UpdateGeneration() {
+    if (gridStorePending && chunkCache && !generationRequested && refineStep == 0 && !lazyPending && erosionBatches == 0 &&
+        std::chrono::steady_clock::now() - gridChangedAt > std::chrono::seconds(1)) {
+        StoreGridToCache();
+    }
+    // Pamet vysledku drzi jen neerodovane stavy (klic GridKey(0)), rozpracovany krok eroze se neuklada
+    if (memoStorePending && !generationRequested && refineStep == 0 && !lazyPending && erosionBatches == 0 &&
+        gridHistory == 0 && std::chrono::steady_clock::now() - gridChangedAt > std::chrono::milliseconds(RESULT_MEMO_SETTLE_MS)) {
+        StoreResultSnapshot();
+    }
+    bool started = generationRequested;
+    if (generationRequested)
+        StartGeneration();
+    if (refineStep == 0 && !lazyPending)
+        return;
+    // GPU jeste nedokoncila pasy z minuleho snimku - dalsi by se jen radily do fronty nad rozpocet
+    PollGenerationQuery();
+    if (generationQueryPending && !started) {
+        lazyVisible.clear();
+        return;
+    }
+    if (lazyPending)
+        RunLazyChunks(lazyVisible, frameBudgetMs);
+    else
+        RunGenerationSlices(frameBudgetMs, started);
+}
+
+void Terrain::FinishGeneration() {
+    if (generationRequested)
+        StartGeneration();
+    FinishErosion();
+    if (refineStep > 0)
+        RunGenerationSlices(-1.0, false);
+    if (lazyPending) {
+        std::vector<std::pair<float, int>> remaining;
+        for (int i = 0; i < int(chunkGenerated.size()); i++) {
+            if (!chunkGenerated[i])
+                remaining.push_back({ 0.0f, i });
+        }
+        RunLazyChunks(remaining, -1.0);
+    }
+}
+
+void Terrain::SetLazyGeneration(bool enabled) {
+    if (enabled == lazyEnabled)
+        return;
+    lazyEnabled = enabled;
+    // Rozpracovana uloha se zopakuje v novem rezimu (jinak by neviditelne chunky zustaly hrube)
+    if (lazyPending || refineStep > 0)
+        RequestGeneration();
+}
+
+// Hruby zastupce cele mrizky (kazdy LAZY_COARSE_STEP-ty texel + TerrainFill), chunky se pak dopocitavaji
+// az pri prvni viditelnosti nebo dotazu na vysku
+void Terrain::StartLazyGeneration() {
+    Shader& program = SelectTerrainProgram();
+    ApplyTerrainUniforms(program);
+    ApplyBiomeMap(program);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, resultsSSBO);
+    glBindBufferBase(GL_UNIFORM_BUFFER, 2, uniformBuffer);
+
+    int latticeSize = (gridSize + LAZY_COARSE_STEP - 1) / LAZY_COARSE_STEP;
+    PollGenerationQuery();
+    glBeginQuery(GL_TIME_ELAPSED, generationQuery);
+    program.SetInt("sampleStep", LAZY_COARSE_STEP);
+    program.SetInt("rowCount", latticeSize);
+    glDispatchCompute((latticeSize + 15) / 16, (latticeSize + 15) / 16, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    DispatchFill(LAZY_COARSE_STEP);
+    glEndQuery(GL_TIME_ELAPSED);
+    generationQueryPending = true;
+    queryTexels = double(latticeSize) * latticeSize;
+    glUseProgram(0);
+
+    // Chunk (cx, cy) pokryva texely [c * CHUNK_FACES, c * CHUNK_FACES + CHUNK), posledni az k okraji mrizky
+    lazyChunksX = (gridSize - 1 + CHUNK_FACES - 1) / CHUNK_FACES;
+    chunkGenerated.assign(size_t(lazyChunksX) * lazyChunksX, 0);
+    chunkHeightsRead.assign(chunkGenerated.size(), 0);
+    heights.resize(size_t(gridSize) * gridSize);
+    lazyRemaining = lazyChunksX * lazyChunksX;
+    lazyVisible.clear();
+    lazyPending = true;
+}
+
+// Chunky serazene podle vzdalenosti, nejblizsi prvni, dokud staci rozpocet (budgetMs < 0 = vsechny).
+// Texely hrubeho zastupce se znovu nepocitaji (skipStep).
+void Terrain::RunLazyChunks(std::vector<std::pair<float, int>>& chunks, double budgetMs) {
+    if (chunks.empty())
+        return;
+    std::sort(chunks.begin(), chunks.end());
+    Shader& program = SelectTerrainProgram();
+    ApplyTerrainUniforms(program);
+    ApplyBiomeMap(program);
+    program.SetInt("skipStep", LAZY_COARSE_STEP);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, resultsSSBO);
+    glBindBufferBase(GL_UNIFORM_BUFFER, 2, uniformBuffer);
+
+    float gridDx = worldSize / gridSize;
+    double chunkTexels = double(CHUNK) * CHUNK * (1.0 - 1.0 / (LAZY_COARSE_STEP * LAZY_COARSE_STEP));
+    double texels = 0.0;
+    glBeginQuery(GL_TIME_ELAPSED, generationQuery);
+    for (const auto& item : chunks) {
+        // Aspon jeden chunk za snimek
+        if (budgetMs >= 0.0 && texels > 0.0 && (texels + chunkTexels) * msPerTexel > budgetMs)
+            break;
+        if (chunkGenerated[item.second])
+            continue;
+        int x0 = item.second % lazyChunksX * CHUNK_FACES;
+        int y0 = item.second / lazyChunksX * CHUNK_FACES;
+        int columns = std::min(CHUNK, gridSize - x0);
+        int rows = std::min(CHUNK, gridSize - y0);
+        // Blok od texelu (x0, y0) se stejnou delkou radku, worldOffset posune souradnice na jeho misto
+        program.SetUInt("outputOffset", y0 * gridSize + x0);
+        glUniform2f(glGetUniformLocation(program.ID, "worldOffset"), x0 * gridDx, y0 * gridDx);
+        program.SetInt("columnCount", columns);
+        program.SetInt("rowCount", rows);
+        glDispatchCompute((columns + 15) / 16, (rows + 15) / 16, 1);
+        chunkGenerated[item.second] = 1;
+        lazyRemaining--;
+        texels += chunkTexels;
+    }
+    chunks.clear();
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    glEndQuery(GL_TIME_ELAPSED);
+    generationQueryPending = true;
+    queryTexels = texels;
+    glUseProgram(0);
+
+    if (lazyRemaining == 0) {
+        lazyPending = false;
+        MarkGridChanged();
+    }
+}
+
+void Terrain::ReadChunkHeights(int chunk) {
+    if (!chunkGenerated[chunk]) {
+        std::vector<std::pair<float, int>> single = { { 0.0f, chunk } };
+        RunLazyChunks(single, -1.0);
+    }
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    int x0 = chunk % lazyChunksX * CHUNK_FACES;
+    int y0 = chunk / lazyChunksX * CHUNK_FACES;
+    int columns = std::min(CHUNK, gridSize - x0);
+    int rows = std::min(CHUNK, gridSize - y0);
+    // Radky chunku nejsou v resultsSSBO souvisle - cte se po radcich, cekani na GPU je jen u prvniho
+    std::vector<Output> row(columns);
+    for (int y = y0; y < y0 + rows; y++) {
+        size_t first = size_t(y) * gridSize + x0;
+        glGetNamedBufferSubData(resultsSSBO, first * sizeof(Output), columns * sizeof(Output), row.data());
+        for (int x = 0; x < columns; x++)
+            heights[first + x] = row[x].position.y;
+    }
+    chunkHeightsRead[chunk] = 1;
+}
+
+void Terrain::DispatchFill(int step) {
+    fillShader.Use();
+    fillShader.SetInt("gridSize", gridSize);
+    fillShader.SetFloat("gridDx", worldSize / gridSize);
+    fillShader.SetInt("sampleStep", step);
+    glDispatchCompute((gridSize + 15) / 16, (gridSize + 15) / 16, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+// Uloha prochazi urovne s krokem coarseStep, coarseStep / 2, ..., 1 (bez progresivniho rezimu jen krok 1).
+// Prvni uroven vyhodnoti celou svou mrizku, dalsi jen texely mimo mrizku predchozi urovne (3/4).
+// Pas = souvisly rozsah radku chunku (CHUNK radku texelu), pocet radku chunku se vybira podle odhadu ceny.
+// Po dokonceni urovne TerrainFill.comp doplni mezery. budgetMs < 0 = bez limitu.
+void Terrain::RunGenerationSlices(double budgetMs, bool forceCoarse) {
+    Shader& program = SelectTerrainProgram();
+    ApplyTerrainUniforms(program);
+    ApplyBiomeMap(program);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, resultsSSBO);
+    glBindBufferBase(GL_UNIFORM_BUFFER, 2, uniformBuffer);
+
+    int chunkRows = (gridSize + CHUNK - 1) / CHUNK;
+    glBeginQuery(GL_TIME_ELAPSED, generationQuery);
+    double spentMs = 0.0;
+    double texels = 0.0;
+    while (refineStep > 0) {
+        int step = refineStep;
+        bool coarsest = step == jobCoarseStep;
+        int latticeSize = (gridSize + step - 1) / step;
+        // Radek chunku obsahuje CHUNK radku texelu, tj. zhruba CHUNK / step radku mrizky
+        double texelsPerChunkRow = double(latticeSize) * CHUNK / step * (coarsest ? 1.0 : 0.75);
+        int slices = chunkRows - refineChunkRow;
+
+        if (budgetMs >= 0.0 && !(forceCoarse && coarsest && step > 1)) {
+            int affordable = int((budgetMs - spentMs) / (texelsPerChunkRow * msPerTexel));
+            // Aspon jeden pas za snimek, jinak by se pri malem rozpoctu nikdy nedokoncilo
+            if (affordable <= 0 && texels > 0.0)
+                break;
+            slices = std::min(slices, std::max(affordable, 1));
+        }
+
+        // Radky mrizky, ktere patri do texelovych radku [firstRow, endRow)
+        int firstRow = refineChunkRow * CHUNK;
+        int endRow = std::min((refineChunkRow + slices) * CHUNK, gridSize);
+        int latticeFirst = (firstRow + step - 1) / step;
+        int latticeEnd = (endRow + step - 1) / step;
+        int rows = latticeEnd - latticeFirst;
+
+        if (rows > 0) {
+            program.Use();
+            program.SetInt("sampleStep", step);
+            program.SetInt("skipStep", coarsest ? 0 : step * 2);
+            program.SetInt("rowOffset", latticeFirst);
+            program.SetInt("rowCount", rows);
+            glDispatchCompute((latticeSize + 15) / 16, (rows + 15) / 16, 1);
+        }
+        spentMs += slices * texelsPerChunkRow * msPerTexel;
+        texels += slices * texelsPerChunkRow;
+        refineChunkRow += slices;
+
+        if (refineChunkRow >= chunkRows) {
+            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+            if (step > 1)
+                DispatchFill(step);
+            refineStep = step / 2;
+            refineChunkRow = 0;
+            if (refineStep == 0)
+                MarkGridChanged();
+        }
+    }
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    glEndQuery(GL_TIME_ELAPSED);
+    generationQueryPending = true;
+    queryTexels = texels;
+    glUseProgram(0);
+}
+
+void Terrain::SetLayerCache(bool enabled) {
+    layerCacheEnabled = enabled;
+    if (enabled) {
+        if (!layerShader) {
+            layerShader = std::make_unique<Shader>("Shaders/Terrain.comp", "#define LAYER_PASS\n");
+            recombineShader = std::make_unique<Shader>("Shaders/TerrainRecombine.comp");
+        }
+        // Opakovane zapnuti jen zahodi platnost cache, buffer mapy biomu zustava
+        if (biomeMapSSBO == 0) {
+            glGenBuffers(1, &biomeMapSSBO);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, biomeMapSSBO);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, size_t(gridSize) * gridSize * BIOME_CELL_SIZE, NULL, GL_DYNAMIC_DRAW);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        }
+    }
+    else {
+        glDeleteBuffers(1, &biomeMapSSBO);
+        glDeleteBuffers(1, &layerSSBO);
+        biomeMapSSBO = layerSSBO = 0;
+    }
+    for (int i = 0; i < LAYER_COUNT; i++)
+        layerSlots[i] = -1;
+    layerSlotCount = layerSlotCapacity = 0;
+    biomeMapValid = false;
+    validLayers = 0;
+
+    RequestGeneration();
+}
+
+void Terrain::InvalidateLayers() {
+    const TerrainSettings& s = settings;
+    const TerrainSettings& old = layerSettings;
+    // Voronoi mapa biomu zavisi na seedu, scale, edgeSharpness a povolenych biomech - s ni i vsechny vrstvy
+    if (s.seed != old.seed || s.scale != old.scale || s.edgeSharpness != old.edgeSharpness ||
+        (BiomeKey(uniforms) & 0xF) != (BiomeKey(layerUniforms) & 0xF)) {
+        biomeMapValid = false;
+    }
+    if (!biomeMapValid) {
+        validLayers = 0;
+    }
+    else {
+        const Params* biomes[3] = { &uniforms.Plains, &uniforms.Mountains, &uniforms.Dunes };
+        const Params* oldBiomes[3] = { &layerUniforms.Plains, &layerUniforms.Mountains, &layerUniforms.Dunes };
+        bool octavesChanged = s.octaves != old.octaves || s.persistence != old.persistence || s.lacunarity != old.lacunarity ||
+            s.bakedNoise != old.bakedNoise;
+        for (int b = 0; b < 3; b++) {
+            uint32_t stale = 0;
+            // fbm, ridge (fbm2) i warp morphed Voronoi pouzivaji oktavy
+            if (octavesChanged) stale |= TERM_FBM | TERM_RIDGE | TERM_MORPHED;
+            if (biomes[b]->fbmFreq != oldBiomes[b]->fbmFreq) stale |= TERM_FBM;
+            if (biomes[b]->voroFreq != oldBiomes[b]->voroFreq) stale |= TERM_VORONOI;
+            if (biomes[b]->morphedvoroFreq != oldBiomes[b]->morphedvoroFreq) stale |= TERM_MORPHED;
+            if (biomes[b]->ridgeFreq != oldBiomes[b]->ridgeFreq) stale |= TERM_RIDGE;
+            if (biomes[b]->sandFreq != oldBiomes[b]->sandFreq) stale |= TERM_SAND;
+            validLayers &= ~(stale << (5 * b));
+        }
+    }
+    layerSettings = settings;
+    layerUniforms = uniforms;
+}
+
+// Dopocita chybejici vrstvy (Terrain.comp s LAYER_PASS) a slozi z nich vysku a normalu (TerrainRecombine.comp)
+void Terrain::DispatchLayerCache() {
+    InvalidateLayers();
+
+    // Sloty se pridelujou jen vrstvam s nenulovou amplitudou u povoleneho biomu a uz se neuvolnuji
+    uint32_t needed = BiomeKey(uniforms) >> 4;
+    for (int i = 0; i < LAYER_COUNT; i++) {
+        if (((needed >> i) & 1) && layerSlots[i] < 0)
+            layerSlots[i] = layerSlotCount++;
+    }
+    if (layerSlotCount > layerSlotCapacity) {
+        // Novy buffer => obsah starych vrstev se ztraci
+        glDeleteBuffers(1, &layerSSBO);
+        glGenBuffers(1, &layerSSBO);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, layerSSBO);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, size_t(gridSize) * gridSize * layerSlotCount * 3 * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        layerSlotCapacity = layerSlotCount;
+        validLayers = 0;
+    }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, biomeMapSSBO);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, layerSSBO);
+
+    uint32_t dirty = needed & ~validLayers;
+    if (!biomeMapValid || dirty) {
+        ApplyTerrainUniforms(*layerShader);
+        layerShader->SetUInt("dirtyLayers", dirty);
+        layerShader->SetInt("updateMap", biomeMapValid ? 0 : 1);
+        glUniform1iv(glGetUniformLocation(layerShader->ID, "layerSlots"), LAYER_COUNT, layerSlots);
+        glDispatchCompute((gridSize + 15) / 16, (gridSize + 15) / 16, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        biomeMapValid = true;
+        validLayers |= dirty;
+    }
+
+    recombineShader->Use();
+    recombineShader->SetInt("gridSize", gridSize);
+    recombineShader->SetFloat("gridDx", worldSize / gridSize);
+    recombineShader->SetFloat("heightScale", settings.heightScale);
+    recombineShader->SetFloat("scale", settings.scale);
+    glUniform1iv(glGetUniformLocation(recombineShader->ID, "layerSlots"), LAYER_COUNT, layerSlots);
+    glDispatchCompute((gridSize + 15) / 16, (gridSize + 15) / 16, 1);
+}
+
+// Precte vysledek timer query, pokud uz je k dispozici, a zpresni odhad ceny texelu
+void Terrain::PollGenerationQuery() {
+    if (!generationQueryPending)
+        return;
+    GLint available = 0;
+    glGetQueryObjectiv(generationQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+        return;
+    GLuint64 elapsed = 0;
+    glGetQueryObjectui64v(generationQuery, GL_QUERY_RESULT, &elapsed);
+    generationTimeMs = elapsed * 1e-6;
+    generationQueryPending = false;
+    // Male davky jsou zatizene rezii dispatche
+    if (queryTexels >= 4096.0)
+        msPerTexel = 0.5 * msPerTexel + 0.5 * generationTimeMs / queryTexels;
+}
+
+double Terrain::GetGenerationTime() {
+    PollGenerationQuery();
+    return generationTimeMs;
+}
+
+// Tabulka feature bodu i baked sum patri k jednomu seedu, galerie je proto nepouziva
+void Terrain::GenerateGallery(const std::vector<unsigned int>& seeds, int thumbSize) {
+    int count = std::min(int(seeds.size()), GALLERY_MAX);
+    if (count == 0 || thumbSize <= 0)
+        return;
+    if (!galleryShader)
+        galleryShader = std::make_unique<Shader>("Shaders/Terrain.comp", "#define GALLERY_PASS\n");
+
+    int columns = int(std::ceil(std::sqrt(double(count))));
+    int rows = (count + columns - 1) / columns;
+    if (galleryTex == 0 || thumbSize != galleryThumbSize || columns != galleryColumns || rows != galleryRows) {
+        glDeleteTextures(1, &galleryTex);
+        glCreateTextures(GL_TEXTURE_2D, 1, &galleryTex);
+        glTextureStorage2D(galleryTex, 1, GL_RGBA8, columns * thumbSize, rows * thumbSize);
+        glTextureParameteri(galleryTex, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTextureParameteri(galleryTex, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        galleryThumbSize = thumbSize;
+        galleryColumns = columns;
+        galleryRows = rows;
+    }
+
+    ApplyTerrainUniforms(*galleryShader);
+    galleryShader->SetInt("gridSize", thumbSize);
+    galleryShader->SetFloat("gridDx", worldSize / thumbSize);
+    galleryShader->SetInt("featureExtent", 0);
+    galleryShader->SetInt("bakedNoise", 0);
+    galleryShader->SetInt("galleryColumns", columns);
+    glUniform1uiv(glGetUniformLocation(galleryShader->ID, "gallerySeeds"), count, seeds.data());
+    glBindBufferBase(GL_UNIFORM_BUFFER, 2, uniformBuffer);
+    glBindImageTexture(2, galleryTex, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+    glDispatchCompute((thumbSize + 15) / 16, (thumbSize + 15) / 16, count);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+    glUseProgram(0);
+
+    gallerySeeds.assign(seeds.begin(), seeds.begin() + count);
+}
+
+double Terrain::BenchmarkGeneration(int runs) {
+    DispatchTerrain(); // zahrati
+    double total = 0.0;
+    for (int i = 0; i < runs; i++) {
+        DispatchTerrain();
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(generationQuery, GL_QUERY_RESULT, &elapsed);
+        total += elapsed * 1e-6;
+    }
+    generationQueryPending = false;
+    generationTimeMs = total / runs;
+    return generationTimeMs;
+}
+
+void Terrain::SetAnalyticNormals(bool enabled) {
+    settings.analyticNormals = enabled;
+    RequestGeneration();
+}
+
 void Terrain::ComputeNormals() {
     normalShader.Use();
 
@@ -295,57 +1511,343 @@ void Terrain::ComputeNormals() {
 }
 //Eroze
 void Terrain::ComputeErosion(Erosion erosion) {
-    erosionShader.Use(); // Aktivace erosion compute shaderu
+    FinishGeneration(); // eroze musi bezet na presne vyskove mape
+    StartErosionStep(erosion);
+    RunErosionBatches(erosionBatches - erosionBatch);
+}
+
+// Krok eroze je v historii mrizky od sveho zacatku, davky se pak dopocitavaji v dalsich snimcich.
+// Vraci false, pokud byl vysledek kroku v cache (zadne davky).
+bool Terrain::StartErosionStep(const Erosion& erosion) {
+    bool pipes = erosion.model == EROSION_PIPES;
+    // Toky trubek navazuji jen na krok modelu trubek nad toutez mrizkou
+    bool pipeContinues = pipes && pipeFluxSSBO != 0 && pipeHistory == gridHistory;
+    gridHistory = HashErosionStep(gridHistory, erosion, dropletIdx);
+    if (erosionTileSize > 0 && !pipes)
+        gridHistory = HashValue(HashValue(gridHistory, erosionTileSize), erosionHalo);
+    erosionJob = erosion;
+    erosionBatch = erosionBatches = 0;
+    // Snimek pro pamet vysledku by uz zachytil erodovanou mrizku pod klicem GridKey(0)
+    memoStorePending = false;
+    if (chunkCache && LoadGridFromCache(GridKey(gridHistory))) {
+        MarkGridChanged(); // i pri zasahu - posune hlavicku pro obnoveni eroze
+        return false;
+    }
+    if (pipes) {
+        if (!pipeContinues)
+            ResetPipeErosion();
+        pipeHistory = gridHistory;
+        erosionBatches = std::max(erosion.pipeIterations, 0); // davka = jedna iterace
+    }
+    // Dlazdicova eroze bezi v jednom dispatchi, je to tedy jedna davka
+    else
+        erosionBatches = erosionTileSize > 0 ? 1 : (std::max(erosion.numDroplets, 0) + EROSION_BATCH - 1) / EROSION_BATCH;
+    if (erosionBatches == 0)
+        MarkGridChanged();
+    return erosionBatches > 0;
+}
+
+// Dalsich count davek rozpracovaneho kroku, po posledni se mrizka oznaci jako zmenena (ulozeni do cache)
+void Terrain::RunErosionBatches(int count) {
+    count = std::min(count, erosionBatches - erosionBatch);
+    if (count <= 0)
+        return;
+    if (erosionJob.model == EROSION_PIPES)
+        DispatchPipeErosion(erosionJob, count);
+    else if (erosionTileSize > 0)
+        DispatchTiledErosion(erosionJob, dropletIdx);
+    else
+        DispatchDropletErosion(erosionJob, dropletIdx, erosionBatch, count);
+    erosionBatch += count;
+    if (erosionBatch == erosionBatches) {
+        erosionBatch = erosionBatches = 0;
+        MarkGridChanged();
+    }
+}
+
+// Rozpracovany krok se musi dokoncit pred vsim, co cte nebo meni vysky (jinak by historie neodpovidala mrizce)
+void Terrain::FinishErosion() {
+    RunErosionBatches(erosionBatches - erosionBatch);
+}
+
+void Terrain::UpdateErosion(const Erosion& erosion, float budgetMs) {
+    FinishGeneration();
+    // Mereni predchozich snimku - GPU muze byt o snimek pozadu, pak se tento snimek nemeri
+    if (erosionQueryPending) {
+        GLint available = 0;
+        glGetQueryObjectiv(erosionQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(erosionQuery, GL_QUERY_RESULT, &elapsed);
+            erosionQueryPending = false;
+            msPerErosionBatch = 0.5 * msPerErosionBatch + 0.5 * elapsed * 1e-6 / erosionQueryBatches;
+        }
+    }
+
+    int budget = std::max(1, int(budgetMs / msPerErosionBatch));
+    bool measure = !erosionQueryPending;
+    if (measure)
+        glBeginQuery(GL_TIME_ELAPSED, erosionQuery);
+    int batches = 0;
+    // Kroky z cache nestoji nic, ale omezuji se taky (jinak by se mohla cela historie nacist v jednom snimku)
+    for (int steps = 0; batches < budget && steps < budget; steps++) {
+        if (erosionBatch == erosionBatches && !StartErosionStep(erosion))
+            continue;
+        int count = std::min(budget - batches, erosionBatches - erosionBatch);
+        RunErosionBatches(count);
+        batches += count;
+    }
+    if (measure) {
+        glEndQuery(GL_TIME_ELAPSED);
+        erosionQueryPending = batches > 0;
+        erosionQueryBatches = batches;
+    }
+    erosionBatchesPerFrame = batches;
+    ComputeNormals();
+}
 
+// Offline rezim: iterations kroku za sebou bez casoveho limitu, normaly az na konci
+double Terrain::RunErosion(const Erosion& erosion, int iterations) {
+    FinishGeneration();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        StartErosionStep(erosion);
+        FinishErosion();
+    }
+    ComputeNormals();
+    glFinish();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Terrain::ApplyErosionUniforms(Shader& shader, const Erosion& erosion, int dropletStep) {
+    // Tabulka stetce se nahraje jen pri zmene polomeru
+    if (brushSSBO == 0 || brushRadius != erosion.erosionRadius) {
+        std::vector<BrushTap> brush = BuildErosionBrush(erosion.erosionRadius);
+        glDeleteBuffers(1, &brushSSBO);
+        glCreateBuffers(1, &brushSSBO);
+        glNamedBufferStorage(brushSSBO, brush.size() * sizeof(BrushTap), brush.data(), 0);
+        brushRadius = erosion.erosionRadius;
+        brushSize = int(brush.size());
+    }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 8, brushSSBO);
+
+    shader.Use(); // Aktivace erosion compute shaderu
 
     // Nastavení uniformů
-    glUniform1i(glGetUniformLocation(erosionShader.ID, "gridSize"), gridSize);
-    glUniform1i(glGetUniformLocation(erosionShader.ID, "dropletIdx"), dropletIdx);
-    glUniform1i(glGetUniformLocation(erosionShader.ID, "numDroplets"), erosion.numDroplets); // Počet kapek vody
-    glUniform1f(glGetUniformLocation(erosionShader.ID, "erosionRate"), erosion.erosionRate);
-    glUniform1f(glGetUniformLocation(erosionShader.ID, "depositionRate"), erosion.depositionRate);
-    glUniform1f(glGetUniformLocation(erosionShader.ID, "inertia"), erosion.inertia);
-    glUniform1f(glGetUniformLocation(erosionShader.ID, "sedimentCapacityFactor"), erosion.sedimentCapacityFactor);
-    glUniform1f(glGetUniformLocation(erosionShader.ID, "minSedimentCapacity"), erosion.minSedimentCapacity);
-    glUniform1f(glGetUniformLocation(erosionShader.ID, "erodeSpeed"), erosion.erodeSpeed);
-    glUniform1f(glGetUniformLocation(erosionShader.ID, "depositSpeed"), erosion.depositSpeed);
-    glUniform1f(glGetUniformLocation(erosionShader.ID, "gravity"), erosion.gravity);
-    glUniform1f(glGetUniformLocation(erosionShader.ID, "initialWaterVolume"), erosion.initialWaterVolume);
-    glUniform1f(glGetUniformLocation(erosionShader.ID, "initialSpeed"), erosion.initialSpeed);
+    glUniform1i(glGetUniformLocation(shader.ID, "dropletIdx"), dropletStep);
+    glUniform1i(glGetUniformLocation(shader.ID, "brushSize"), brushSize);
+    glUniform1i(glGetUniformLocation(shader.ID, "numDroplets"), erosion.numDroplets); // Počet kapek vody
+    glUniform1f(glGetUniformLocation(shader.ID, "erosionRate"), erosion.erosionRate);
+    glUniform1f(glGetUniformLocation(shader.ID, "depositionRate"), erosion.depositionRate);
+    glUniform1f(glGetUniformLocation(shader.ID, "inertia"), erosion.inertia);
+    glUniform1f(glGetUniformLocation(shader.ID, "sedimentCapacityFactor"), erosion.sedimentCapacityFactor);
+    glUniform1f(glGetUniformLocation(shader.ID, "minSedimentCapacity"), erosion.minSedimentCapacity);
+    glUniform1f(glGetUniformLocation(shader.ID, "erodeSpeed"), erosion.erodeSpeed);
+    glUniform1f(glGetUniformLocation(shader.ID, "depositSpeed"), erosion.depositSpeed);
+    glUniform1f(glGetUniformLocation(shader.ID, "gravity"), erosion.gravity);
+    glUniform1f(glGetUniformLocation(shader.ID, "initialWaterVolume"), erosion.initialWaterVolume);
+    glUniform1f(glGetUniformLocation(shader.ID, "initialSpeed"), erosion.initialSpeed);
+}
+
+void Terrain::DispatchErosion(GLuint outputs, GLuint ints, int size, const Erosion& erosion, int dropletStep,
+    glm::ivec2 dropletOffset) {
+    ApplyErosionUniforms(erosionShader, erosion, dropletStep);
+    glUniform1i(glGetUniformLocation(erosionShader.ID, "gridSize"), size);
+    glUniform2i(glGetUniformLocation(erosionShader.ID, "dropletOffset"), dropletOffset.x, dropletOffset.y);
 
     // Připojení SSBO
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, resultsSSBO);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, outputs);
     //Vysledek eroze
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, intsSSBO);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, ints);
 
     // Spuštění výpočtu compute shaderu
-    glDispatchCompute((gridSize + 15) / 16, (gridSize + 15) / 16, 1);
+    glDispatchCompute((size + 15) / 16, (size + 15) / 16, 1);
     glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT); // Synchronizace s GPU
 
     erosionApplyShader.Use();
-    glUniform1i(glGetUniformLocation(erosionApplyShader.ID, "gridSize"), gridSize);
+    glUniform1i(glGetUniformLocation(erosionApplyShader.ID, "gridSize"), size);
 
-    glDispatchCompute((gridSize + 15) / 16, (gridSize + 15) / 16, 1);
+    glDispatchCompute((size + 15) / 16, (size + 15) / 16, 1);
     glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 
     glUseProgram(0);
 }
 
-void Terrain::UpdateTerrain(float scale, float edgeSharpness, float heightScale, int octaves,
-    float persistence, float lacunarity, unsigned int seed) {
-    computeShader.Use();  // Aktivace compute shaderu
+// Davky first .. first + count - 1 z Erosion::numDroplets kapek po EROSION_BATCH, kazda davka ma vlastni
+// dropletIdx a po ni se zmeny hned propisou (dalsi davka uz tece po erodovanem terenu)
+void Terrain::DispatchDropletErosion(const Erosion& erosion, int dropletStep, int first, int count) {
+    if (!dropletErosionShader)
+        dropletErosionShader = std::make_unique<Shader>("Shaders/Erosion.comp", "#define DROPLET_BATCH\n");
+    int batches = (erosion.numDroplets + EROSION_BATCH - 1) / EROSION_BATCH;
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, resultsSSBO);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, intsSSBO);
+
+    for (int batch = first; batch < std::min(first + count, batches); batch++) {
+        int batchDroplets = std::min(erosion.numDroplets - batch * EROSION_BATCH, EROSION_BATCH);
+        ApplyErosionUniforms(*dropletErosionShader, erosion, dropletStep * batches + batch);
+        dropletErosionShader->SetInt("gridSize", gridSize);
+        dropletErosionShader->SetInt("batchCount", batchDroplets);
+        glDispatchCompute((batchDroplets + 255) / 256, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+        erosionApplyShader.Use();
+        glUniform1i(glGetUniformLocation(erosionApplyShader.ID, "gridSize"), gridSize);
+        glDispatchCompute((gridSize + 15) / 16, (gridSize + 15) / 16, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+    glUseProgram(0);
+}
+
+// Vynulovane toky a rychlosti, voda a sediment zustavaji v Output
+void Terrain::ResetPipeErosion() {
+    size_t bytes = size_t(gridSize) * gridSize * sizeof(glm::vec4);
+    if (pipeFluxSSBO == 0) {
+        glCreateBuffers(1, &pipeFluxSSBO);
+        glNamedBufferStorage(pipeFluxSSBO, bytes, NULL, GL_DYNAMIC_STORAGE_BIT);
+        glCreateBuffers(1, &pipeFlowSSBO);
+        glNamedBufferStorage(pipeFlowSSBO, bytes, NULL, GL_DYNAMIC_STORAGE_BIT);
+    }
+    glClearNamedBufferData(pipeFluxSSBO, GL_RGBA32F, GL_RGBA, GL_FLOAT, NULL);
+    glClearNamedBufferData(pipeFlowSSBO, GL_RGBA32F, GL_RGBA, GL_FLOAT, NULL);
+}
 
-    computeShader.SetFloat("scale", scale);
-    computeShader.SetFloat("edgeSharpness", edgeSharpness);
-    computeShader.SetFloat("heightScale", heightScale);
-    computeShader.SetUInt("octaves", octaves);
-    computeShader.SetFloat("persistence", persistence);
-    computeShader.SetFloat("lacunarity", lacunarity);
-    computeShader.SetUInt("seed", seed);
-    computeShader.SetFloat("gridDx", worldSize / gridSize);
+// iterations iteraci modelu trubek (HydraulicErosion.comp), kazda ze ctyr pruchodu nad celou mrizkou
+void Terrain::DispatchPipeErosion(const Erosion& erosion, int iterations) {
+    if (!pipeShaders[0]) {
+        const char* passes[4] = { "#define FLUX_PASS\n", "#define WATER_PASS\n", "#define EROSION_PASS\n", "" };
+        for (int i = 0; i < 4; i++)
+            pipeShaders[i] = std::make_unique<Shader>("Shaders/HydraulicErosion.comp", passes[i]);
+    }
+    for (auto& shader : pipeShaders) {
+        shader->Use();
+        shader->SetInt("gridSize", gridSize);
+        shader->SetFloat("dt", erosion.timeStep);
+        shader->SetFloat("gravity", erosion.gravity);
+        shader->SetFloat("rainRate", erosion.rainRate);
+        shader->SetFloat("evaporationRate", erosion.evaporationRate);
+        shader->SetFloat("capacityFactor", erosion.pipeCapacity);
+        shader->SetFloat("erodeSpeed", erosion.erodeSpeed);
+        shader->SetFloat("depositSpeed", erosion.depositSpeed);
+    }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, resultsSSBO);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, pipeFluxSSBO);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, pipeFlowSSBO);
+
+    for (int i = 0; i < iterations; i++) {
+        for (auto& shader : pipeShaders) {
+            shader->Use();
+            glDispatchCompute((gridSize + 15) / 16, (gridSize + 15) / 16, 1);
+            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        }
+    }
+    glUseProgram(0);
+}
+
+double Terrain::BenchmarkErosion(const Erosion& erosion, int runs) {
+    FinishGeneration();
+    size_t bytes = size_t(gridSize) * gridSize * sizeof(Output);
+    GLuint backup;
+    glCreateBuffers(1, &backup);
+    glNamedBufferStorage(backup, bytes, NULL, 0);
+    glCopyNamedBufferSubData(resultsSSBO, backup, 0, 0, bytes);
+
+    PollGenerationQuery();
+    double total = 0.0;
+    for (int i = 0; i < runs; i++) {
+        glBeginQuery(GL_TIME_ELAPSED, generationQuery);
+        DispatchErosion(resultsSSBO, intsSSBO, gridSize, erosion, i);
+        glEndQuery(GL_TIME_ELAPSED);
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(generationQuery, GL_QUERY_RESULT, &elapsed);
+        total += elapsed * 1e-6;
+    }
+    glCopyNamedBufferSubData(backup, resultsSSBO, 0, 0, bytes);
+    glDeleteBuffers(1, &backup);
+    return total / runs;
+}
+
+void Terrain::SetTiledErosion(bool enabled, int tileSize, int halo) {
+    erosionTileSize = enabled ? std::max(tileSize, 16) : 0;
+    erosionHalo = std::max(halo, 0);
+    if (!enabled) {
+        glDeleteBuffers(1, &tileHeightsSSBO);
+        glDeleteBuffers(1, &tileDeltasSSBO);
+        tileHeightsSSBO = tileDeltasSSBO = 0;
+        tileBufferCapacity = 0;
+    }
+}
+
+// Vymena okraju -> eroze vsech dlazdic v jednom dispatchi -> secteni prispevku pres svy -> ErosionApply
+void Terrain::DispatchTiledErosion(const Erosion& erosion, int dropletStep) {
+    int tilesX = (gridSize + erosionTileSize - 1) / erosionTileSize;
+    int tileCount = tilesX * tilesX;
+    int side = erosionTileSize + 2 * erosionHalo;
+    size_t texels = size_t(side) * side * tileCount;
+    if (texels > tileBufferCapacity) {
+        glDeleteBuffers(1, &tileHeightsSSBO);
+        glDeleteBuffers(1, &tileDeltasSSBO);
+        glCreateBuffers(1, &tileHeightsSSBO);
+        glNamedBufferStorage(tileHeightsSSBO, texels * sizeof(float), NULL, 0);
+        glCreateBuffers(1, &tileDeltasSSBO);
+        glNamedBufferStorage(tileDeltasSSBO, texels * sizeof(int), NULL, 0);
+        tileBufferCapacity = texels;
+    }
+    if (!tiledErosionShader) {
+        tiledErosionShader = std::make_unique<Shader>("Shaders/Erosion.comp", "#define TILED_EROSION\n");
+        tileGatherShader = std::make_unique<Shader>("Shaders/ErosionTiles.comp", "#define GATHER_PASS\n");
+        tileReconcileShader = std::make_unique<Shader>("Shaders/ErosionTiles.comp");
+    }
+    auto applyTiling = [&](Shader& shader) {
+        shader.Use();
+        shader.SetInt("worldGrid", gridSize);
+        shader.SetInt("tileSize", erosionTileSize);
+        shader.SetInt("halo", erosionHalo);
+        shader.SetInt("tilesX", tilesX);
+    };
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, resultsSSBO);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, intsSSBO);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, tileHeightsSSBO);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, tileDeltasSSBO);
+
+    // Kazda dlazdice dostane vysky vcetne okraje od sousedu, prispevky se nuluji
+    applyTiling(*tileGatherShader);
+    glDispatchCompute((side + 15) / 16, (side + 15) / 16, tileCount);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    ApplyErosionUniforms(*tiledErosionShader, erosion, dropletStep);
+    applyTiling(*tiledErosionShader);
+    tiledErosionShader->SetInt("gridSize", side);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, tileHeightsSSBO);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, tileDeltasSSBO);
+    glDispatchCompute((erosionTileSize + 15) / 16, (erosionTileSize + 15) / 16, tileCount);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    // Kapky, ktere dojely do okraje, pricitaji usazeniny a erozi sousedni dlazdici
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, resultsSSBO);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, intsSSBO);
+    applyTiling(*tileReconcileShader);
+    glDispatchCompute((gridSize + 15) / 16, (gridSize + 15) / 16, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 
+    erosionApplyShader.Use();
+    glUniform1i(glGetUniformLocation(erosionApplyShader.ID, "gridSize"), gridSize);
     glDispatchCompute((gridSize + 15) / 16, (gridSize + 15) / 16, 1);
     glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    glUseProgram(0);
+}
+
+void Terrain::UpdateTerrain(float scale, float edgeSharpness, float heightScale, int octaves,
+    float persistence, float lacunarity, unsigned int seed) {
+    settings.scale = scale;
+    settings.edgeSharpness = edgeSharpness;
+    settings.heightScale = heightScale;
+    settings.octaves = octaves;
+    settings.persistence = persistence;
+    settings.lacunarity = lacunarity;
+    settings.seed = seed;
+
+    RequestGeneration(); // uniformy nastavi ApplyTerrainUniforms
 }
 
 void Terrain::ReadHeightsFromSSBO() {
@@ -353,30 +1855,25 @@ void Terrain::ReadHeightsFromSSBO() {
         std::cerr << "Chyba: SSBO neni inicializovano!\n";
         return;
     }
+    FinishGeneration();
 
     glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
 
     std::vector<Output> tempData(gridSize * gridSize);
-    heights.resize(gridSize * gridSize);
-    biomeIDs.resize(gridSize * gridSize * 3);  // 3 ID na každý bod
-    biomeWeights.resize(gridSize * gridSize * 3); // 3 váhy na každý bod
-
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, resultsSSBO);
     glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, tempData.size() * sizeof(Output), tempData.data());
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 
     // Uložení dat do vektorů
-    for (size_t i = 0; i < tempData.size(); ++i) {
-        heights[i] = tempData[i].position.y;
-
-        biomeIDs[i * 3 + 0] = tempData[i].biomeIDs[0];
-        biomeIDs[i * 3 + 1] = tempData[i].biomeIDs[1];
-        biomeIDs[i * 3 + 2] = tempData[i].biomeIDs[2];
+    SplitOutputs(tempData, heights, biomeIDs, biomeWeights);
+}
 
-        biomeWeights[i * 3 + 0] = tempData[i].biomeWeight[0];
-        biomeWeights[i * 3 + 1] = tempData[i].biomeWeight[1];
-        biomeWeights[i * 3 + 2] = tempData[i].biomeWeight[2];
-    }
+// Kopie celeho resultsSSBO (napr. pro porovnani s CPU backendem)
+void Terrain::ReadOutputs(std::vector<Output>& outputs) {
+    FinishGeneration();
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+    outputs.resize(gridSize * gridSize);
+    glGetNamedBufferSubData(resultsSSBO, 0, outputs.size() * sizeof(Output), outputs.data());
 }
 
 void Terrain::DrawWater(Shader& waterShader, float currentFrame, const glm::mat4& view, const glm::mat4& projection) {
@@ -445,12 +1942,26 @@ float Terrain::GetHeightAt(float worldX, float worldZ) {
     // Výpočet indexu v 1D poli
     int index = z * gridSize + x;
 
+    // Line generovani: chunk se dopocita a precte pri prvnim dotazu, dalsi dotazy v nem uz GPU necekaji
+    if (lazyPending) {
+        int cx = std::min(x / CHUNK_FACES, lazyChunksX - 1);
+        int cz = std::min(z / CHUNK_FACES, lazyChunksX - 1);
+        if (!chunkHeightsRead[cz * lazyChunksX + cx])
+            ReadChunkHeights(cz * lazyChunksX + cx);
+    }
+
     // Vrácení odpovídající výšky
     return heights[index];
 }
 
 //Zmena terenu pomoci gaussovy krivky
 void Terrain::ModifyTerrain(glm::vec3 hitPoint, int mode) {
+    FinishErosion();
+    // Editace je soucast historie mrizky stejne jako eroze
+    gridHistory = HashValue(gridHistory, hitPoint);
+    gridHistory = HashValue(gridHistory, mode);
+    gridHistory = HashValue(gridHistory, glm::vec3(radius, strength, sigma));
+    MarkGridChanged();
     int centerX = static_cast<int>(hitPoint.x + gridSize / 2);
     int centerZ = static_cast<int>(hitPoint.z + gridSize / 2);
 
@@ -487,8 +1998,6 @@ void Terrain::ModifyTerrain(glm::vec3 hitPoint, int mode) {
 }
 
 void Terrain::UpdateBiomeParams(const Params& dunes, const Params& plains, const Params& mountains, const Params& sea) {
-    computeShader.Use();
-
     uniforms.Dunes = dunes;
 
     uniforms.Plains = plains;
@@ -501,8 +2010,7 @@ void Terrain::UpdateBiomeParams(const Params& dunes, const Params& plains, const
     glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(uniforms), &uniforms);
     glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
-    glDispatchCompute((gridSize + 15) / 16, (gridSize + 15) / 16, 1);
-    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    RequestGeneration();
 }
 
 void Terrain::SaveHeightmapAsPNG(const std::string& filename) {
@@ -510,21 +2018,12 @@ void Terrain::SaveHeightmapAsPNG(const std::string& filename) {
         std::cerr << "Chyba: Heightmapa neni nactena!\n";
         return;
     }
-
-    std::vector<uint8_t> imageData(gridSize * gridSize);
-
-    float minH = *std::min_element(heights.begin(), heights.end());
-    float maxH = *std::max_element(heights.begin(), heights.end());
-    float heightRange = maxH - minH;
-    if (heightRange == 0.0f) heightRange = 1.0f;
-
-    for (size_t i = 0; i < heights.size(); ++i) {
-        imageData[i] = static_cast<uint8_t>(255.0f * (heights[i] - minH) / (maxH - minH));
+    if (!WriteHeightmapPNG(filename, heights, gridSize)) {
+        std::cerr << "Chyba: Ukladani heightmapy selhalo!\n";
+    }
+    else {
+        std::cout << "Heightmapa ulozena jako " << filename << std::endl;
     }
-
-    stbi_write_png(filename.c_str(), gridSize, gridSize, 1, imageData.data(), gridSize);
-
-    std::cout << "Heightmapa ulozena jako " << filename << std::endl;
 }
 
 void Terrain::SaveBiomeIDsAsPNG(const std::string& filename) {
@@ -532,16 +2031,7 @@ void Terrain::SaveBiomeIDsAsPNG(const std::string& filename) {
         std::cerr << "Chyba: Biome ID data nejsou nactena!\n";
         return;
     }
-
-    std::vector<uint8_t> imageData(gridSize * gridSize * 3);
-
-    for (size_t i = 0; i < gridSize * gridSize; ++i) {
-        imageData[i * 3 + 0] = static_cast<uint8_t>(biomeIDs[i * 3 + 0] * 64);
-        imageData[i * 3 + 1] = static_cast<uint8_t>(biomeIDs[i * 3 + 1] * 64);
-        imageData[i * 3 + 2] = static_cast<uint8_t>(biomeIDs[i * 3 + 2] * 64);
-    }
-
-    if (!stbi_write_png(filename.c_str(), gridSize, gridSize, 3, imageData.data(), gridSize * 3)) {
+    if (!WriteBiomeIDsPNG(filename, biomeIDs, gridSize)) {
         std::cerr << "Chyba: Ukladani biome ID mapy selhalo!\n";
     }
     else {
@@ -554,16 +2044,7 @@ void Terrain::SaveBlendWeightsAsPNG(const std::string& filename) {
         std::cerr << "Chyba: Biome váhy nejsou nactene!\n";
         return;
     }
-
-    std::vector<uint8_t> imageData(gridSize * gridSize * 3);
-
-    for (size_t i = 0; i < gridSize * gridSize; ++i) {
-        imageData[i * 3 + 0] = static_cast<uint8_t>(255.0f * biomeWeights[i * 3 + 0]);
-        imageData[i * 3 + 1] = static_cast<uint8_t>(255.0f * biomeWeights[i * 3 + 1]);
-        imageData[i * 3 + 2] = static_cast<uint8_t>(255.0f * biomeWeights[i * 3 + 2]);
-    }
-
-    if (!stbi_write_png(filename.c_str(), gridSize, gridSize, 3, imageData.data(), gridSize * 3)) {
+    if (!WriteBlendWeightsPNG(filename, biomeWeights, gridSize)) {
         std::cerr << "Chyba: Ukladani biome weight mapy selhalo!\n";
     }
     else {
@@ -571,3 +2052,119 @@ void Terrain::SaveBlendWeightsAsPNG(const std::string& filename) {
     }
 }
 
+
+bool Terrain::ExportTiled(const std::string& directory, int worldGrid, int tileSize, int halo,
+    const Erosion& erosion, int erosionSteps) {
+    if (worldGrid <= 0 || tileSize <= 0 || halo < 0)
+        return false;
+    FinishGeneration();
+    int tiles = (worldGrid + tileSize - 1) / tileSize;
+    worldGrid = tiles * tileSize;
+    int side = tileSize + 2 * halo; // strana dlazdice vcetne okraje
+    size_t texels = size_t(side) * side;
+    size_t tileTexels = size_t(tileSize) * tileSize;
+    float gridDx = worldSize / gridSize;
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    auto tilePath = [&](int tx, int ty, const char* suffix) {
+        return directory + "/tile_" + std::to_string(tx) + "_" + std::to_string(ty) + suffix;
+    };
+    std::cout << "Dlazdicovy export: svet " << worldGrid << "^2, " << tiles << "x" << tiles << " dlazdic "
+        << side << "^2 (" << texels * (sizeof(Output) + sizeof(int)) / (1024 * 1024) << " MB na GPU)\n";
+
+    GLuint tileSSBO = 0, tileIntsSSBO = 0;
+    glCreateBuffers(1, &tileSSBO);
+    glNamedBufferStorage(tileSSBO, texels * sizeof(Output), NULL, 0);
+    glCreateBuffers(1, &tileIntsSSBO);
+    glNamedBufferStorage(tileIntsSSBO, texels * sizeof(int), NULL, 0);
+    glClearNamedBufferData(tileIntsSSBO, GL_R32I, GL_RED_INTEGER, GL_INT, NULL);
+
+    Shader& program = SelectTerrainProgram();
+    ApplyTerrainUniforms(program);
+    program.SetInt("gridSize", side);
+    program.SetInt("rowCount", side);
+    glBindBufferBase(GL_UNIFORM_BUFFER, 2, uniformBuffer);
+
+    // 1. pruchod: generovani a eroze dlazdic, orezane vysky se docasne ukladaji jako float
+    std::vector<Output> tileData(texels);
+    std::vector<float> tileHeights(tileTexels), tileWeights(tileTexels * 3);
+    std::vector<uint32_t> tileIDs(tileTexels * 3);
+    float minH = FLT_MAX, maxH = -FLT_MAX;
+    bool ok = true;
+    auto start = std::chrono::steady_clock::now();
+    for (int ty = 0; ty < tiles && ok; ty++) {
+        for (int tx = 0; tx < tiles && ok; tx++) {
+            // Prvni texel dlazdice vcetne okraje; Terrain.comp centruje blok kolem side / 2, svet kolem worldGrid / 2
+            glm::ivec2 origin = glm::ivec2(tx, ty) * tileSize - halo;
+            glm::vec2 offset = (glm::vec2(origin) + (side - worldGrid) * 0.5f) * gridDx;
+            program.Use();
+            glUniform2f(glGetUniformLocation(program.ID, "worldOffset"), offset.x, offset.y);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, tileSSBO);
+            glDispatchCompute((side + 15) / 16, (side + 15) / 16, 1);
+            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+            // Kapky ze sousednich dlazdic startuji v okraji se stejnym hashem
+            for (int step = 0; step < erosionSteps; step++)
+                DispatchErosion(tileSSBO, tileIntsSSBO, side, erosion, step, origin);
+            glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+            glGetNamedBufferSubData(tileSSBO, 0, texels * sizeof(Output), tileData.data());
+
+            for (int y = 0; y < tileSize; y++) {
+                for (int x = 0; x < tileSize; x++) {
+                    const Output& o = tileData[size_t(y + halo) * side + x + halo];
+                    size_t i = size_t(y) * tileSize + x;
+                    tileHeights[i] = o.position.y;
+                    minH = std::min(minH, o.position.y);
+                    maxH = std::max(maxH, o.position.y);
+                    for (int j = 0; j < 3; j++) {
+                        tileIDs[i * 3 + j] = o.biomeIDs[j];
+                        tileWeights[i * 3 + j] = o.biomeWeight[j];
+                    }
+                }
+            }
+            std::ofstream heightFile(tilePath(tx, ty, ".f32"), std::ios::binary);
+            heightFile.write(reinterpret_cast<const char*>(tileHeights.data()), tileTexels * sizeof(float));
+            ok = bool(heightFile) && WriteBiomeIDsPNG(tilePath(tx, ty, "_biomeids.png"), tileIDs, tileSize) &&
+                WriteBlendWeightsPNG(tilePath(tx, ty, "_biomeweights.png"), tileWeights, tileSize);
+        }
+        std::cout << "Dlazdicovy export: radek " << ty + 1 << "/" << tiles << std::endl;
+    }
+
+    glDeleteBuffers(1, &tileSSBO);
+    glDeleteBuffers(1, &tileIntsSSBO);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, resultsSSBO);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, intsSSBO);
+    glUseProgram(0);
+
+    // 2. pruchod: normalizace na rozsah celeho sveta do PNG dlazdic a RAW mapy sveta
+    std::ofstream raw(directory + "/heightmap.r16", std::ios::binary);
+    ok = ok && bool(raw);
+    for (int ty = 0; ty < tiles; ty++) {
+        for (int tx = 0; tx < tiles; tx++) {
+            // Docasne soubory se mazou i po chybe
+            std::string floatPath = tilePath(tx, ty, ".f32");
+            if (ok) {
+                std::ifstream heightFile(floatPath, std::ios::binary);
+                heightFile.read(reinterpret_cast<char*>(tileHeights.data()), tileTexels * sizeof(float));
+                ok = bool(heightFile) &&
+                    WriteHeightmapPNG(tilePath(tx, ty, "_heightmap.png"), tileHeights, tileSize, minH, maxH) &&
+                    WriteHeightTileR16(raw, tileHeights, tileSize, tx * tileSize, ty * tileSize, worldGrid, minH, maxH);
+            }
+            std::filesystem::remove(floatPath, ec);
+        }
+    }
+    raw.close();
+
+    std::ofstream manifest(directory + "/world.txt");
+    manifest << "worldGrid = " << worldGrid << "\ntileSize = " << tileSize << "\ntiles = " << tiles
+        << "\ntexelSize = " << gridDx << "\nminHeight = " << minH << "\nmaxHeight = " << maxH
+        << "\nerosionSteps = " << erosionSteps << "\nseed = " << settings.seed << "\n";
+    ok = ok && bool(manifest);
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!ok)
+        std::cerr << "Chyba: dlazdicovy export do " << directory << " selhal\n";
+    else
+        std::cout << "Dlazdicovy export hotov za " << elapsed << " s: " << directory << std::endl;
+    return ok;
+}
@@ -2,61 +2,23 @@
 #define TERRAIN_H
 
 #include <vector>
+#include <string>
+#include <unordered_map>
+#include <memory>
+#include <chrono>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "Shader.h"
 #include "stb_image_write.h"
+#include "TerrainTypes.h"
+#include "ChunkCache.h"
+#include "TerrainExport.h"
+#include "NoiseGraph.h"
 #include <math.h>
 
 
 
-struct alignas(16) Params {
-    float fbmFreq;
-    float fbmAmp;
-    float ridgeFreq;
-    float ridgeAmp;
-    float voroFreq;
-    float voroAmp;
-    float morphedvoroFreq;
-    float morphedvoroAmp;
-    float sandFreq;
-    float sandAmp;
-    int enabled;
-    int padding1, padding2, padding3;
-};
-
-struct alignas(16) Output {
-    glm::vec4 position;
-    glm::vec4 normal;
-    unsigned int biomeIDs[3];
-    float biomeWeight[3];
-    float waterAmount;
-    float sedimentAmount;
-};
-
-
-struct Uniforms {
-    Params Dunes;
-    Params Plains;
-    Params Mountains;
-    Params Sea;
-};
-
-struct Erosion {
-    float erosionRate = 1;
-    float depositionRate = 1;
-    int numDroplets = 50000;
-    float inertia = 0.1;
-    float sedimentCapacityFactor = 2.0;
-    float minSedimentCapacity = 0.005;
-    float erodeSpeed = 0.3;
-    float depositSpeed = 0.1;
-    float gravity = 4.0;
-    float initialWaterVolume = 1.0;
-    float initialSpeed = 0.3;
-};
-
 struct ChunkDraw {
     int vertexOffset;
     int chunkX;
@@ -70,10 +32,104 @@ public:
 
     void Draw(Shader terrain, glm::mat4 view, glm::mat4 projection, glm::vec3 cameraPos);
     void ComputeTerrain();
+    void SetAnalyticNormals(bool enabled);
+    // Tabulka feature bodu Voronoi (jitter, body dun, hash biomu) pro bunky pokryvajici mrizku, stavi se
+    // jednou pro seed a meritko. Terrain.comp z ni cte misto hashovani, vysledek je stejny.
+    void SetFeatureTable(bool enabled);
+    // Rychly nahled: fbm a fbm2 vzorkuji periodicke dlazdice Perlin/simplex oktavy (hardwarova filtrace,
+    // mip podle frekvence oktavy) misto analytickeho vypoctu. Dlazdice se peceou jednou pro seed.
+    void SetBakedNoise(bool enabled);
+    // Mapa biomu v nizsim rozliseni: BIOME_PASS spocita voronoiMap jen pro kazdy step-ty texel (vahy podle ID
+    // biomu vcetne derivaci), vyska a biomy v Output se z ni bilinearne interpoluji. Jen pevna mrizka.
+    void SetBiomeMap(bool enabled, int step = 4);
+    // Grafy sumu biomu (NoiseGraph.h): specializovane varianty Terrain.comp dostanou misto pevneho combinedNoise
+    // GLSL vygenerovany ze zkompilovanych grafu. Biom bez vlastniho grafu pouzije BiomeNoiseGraph z Params.
+    void SetNoiseGraphs(bool enabled);
+    bool GetNoiseGraphs() const { return noiseGraphsEnabled; }
+    // Vlastni graf biomu s ID 1-3 (prazdny graf vrati vychozi). Zapne grafy, obchazi cache vrstev.
+    void SetBiomeGraph(int biomeID, const NoiseGraph& graph);
+    bool HasCustomGraphs() const { return customGraphHash != 0; }
+    // Pocet uzlu grafu biomu po kompilaci (0 = biom se nepocita)
+    int GetGraphNodeCount(int biomeID) const { return int(compiledGraphs[biomeID].nodes.size()); }
+    // Cache surovych vrstev sumu (fbm, ridge, Voronoi, morphed Voronoi, duny) pro kazdy biom. Zmena amplitud
+    // nebo heightScale pak jen prepocita linearni kombinaci, frekvence a nastaveni oktav invaliduji jen
+    // dotcene vrstvy. Pameti stoji 12 B na texel a aktivni vrstvu, normala je vzdy z analytickych derivaci.
+    void SetLayerCache(bool enabled);
+    bool IsLayerCacheEnabled() const { return layerCacheEnabled; }
+    // Progresivni generovani: uloha nejdriv spocita kazdy coarseStep-ty texel (mezery se interpoluji)
+    // a mrizka se zjemnuje v dalsich snimcich
+    void SetProgressive(bool enabled, int coarseStep = 8);
+    // GPU cas na generovani za snimek, uloha se deli na pasy po radcich chunku
+    void SetFrameBudget(float budgetMs) { frameBudgetMs = budgetMs; }
+    // Planovac generovani, volat jednou za snimek po GUI: zmeny parametru z celeho snimku slouci
+    // do jedne ulohy a odesle z ni pasy do rozpoctu
+    void UpdateGeneration();
+    // Dokonci cekajici ulohu bez casoveho limitu (pred ctenim nebo upravou vysek)
+    void FinishGeneration();
+    bool IsGenerating() const { return generationRequested || refineStep > 0 || lazyPending; }
+    // Line generovani pevne mrizky: uloha spocita jen hrubeho zastupce cele mrizky a chunky v plnem rozliseni
+    // dopocitava az pri prvni viditelnosti v Draw (nejblizsi prvni, v rozpoctu snimku) nebo v GetHeightAt.
+    // FinishGeneration (eroze, editace, export) dopocita zbytek. Ma prednost pred progresivnim rezimem.
+    void SetLazyGeneration(bool enabled);
+    bool IsLazyGeneration() const { return lazyEnabled; }
+    // Pocet chunku, ktere jeste nemaji plne rozliseni (0 mimo line generovani)
+    int GetPendingChunks() const { return lazyPending ? lazyRemaining : 0; }
+    // Streamovany svet: toroidni prstenec ringSize x ringSize chunku kolem kamery ve vlastnim SSBO, chunk
+    // (cx, cz) lezi ve slotu (cx mod ringSize, cz mod ringSize) - pamet nezavisi na tom, kam kamera doleti.
+    // Pevna mrizka (eroze, editace, export) zustava beze zmeny, jen se nevykresluje.
+    void SetStreaming(bool enabled, int ringSize = 32);
+    bool IsStreaming() const { return streamingEnabled; }
+    // Vygeneruje chybejici a zastarale chunky okna kolem kamery (posunuteho ve smeru pohybu),
+    // nejblizsi prvni a v ramci rozpoctu snimku. Volat jednou za snimek.
+    void UpdateStreaming(glm::vec3 cameraPos, float deltaTime);
+    // Diskova cache hotovych chunku v adresari Cache/ (klic = hash parametru, u pevne mrizky i historie
+    // eroze a editaci). Shodne chunky se nactou misto dispatche Terrain.comp nebo eroze.
+    // resumeErosion: pri generovani se nacte posledni ulozeny erodovany stav tehoz terenu.
+    void SetDiskCache(bool enabled, uint64_t maxBytes = 2048ull * 1024 * 1024, bool resumeErosion = true);
+    ChunkCache* GetDiskCache() { return chunkCache.get(); }
+    // LRU kopii resultsSSBO ve VRAM podle hashe vsech parametru - navrat k nedavne sade parametru (A/B, undo)
+    // je glCopyNamedBufferSubData misto generovani. Ulozi se jen vysledek, ktery vydrzi RESULT_MEMO_SETTLE_MS.
+    void SetResultMemo(bool enabled, uint64_t budgetBytes = 1024ull * 1024 * 1024);
+    size_t GetResultMemoCount() const { return resultMemo.size(); }
+    uint64_t GetResultMemoBytes() const { return uint64_t(resultMemo.size()) * gridSize * gridSize * sizeof(Output); }
+    // Galerie nahledu: az GALLERY_MAX seedu s aktualnimi parametry v jednom dispatchi (treti rozmer = index
+    // seedu), kazdy thumbSize x thumbSize pres cely svet, do RGBA8 atlasu GetGalleryTexture()
+    void GenerateGallery(const std::vector<unsigned int>& seeds, int thumbSize = 128);
+    GLuint GetGalleryTexture() const { return galleryTex; }
+    int GetGalleryColumns() const { return galleryColumns; }
+    int GetGalleryRows() const { return galleryRows; }
+    const std::vector<unsigned int>& GetGallerySeeds() const { return gallerySeeds; }
+    // Doba posledniho dispatche Terrain.comp v ms (GL_TIME_ELAPSED), vysledek se cte bez cekani
+    double GetGenerationTime();
+    // Prumerna doba dispatche Terrain.comp z runs opakovani (ceka na GPU)
+    double BenchmarkGeneration(int runs);
+    // Spusti kompilaci pozadovane varianty Terrain.comp a sbira dokoncene, volat jednou za snimek
+    void PollShaderVariants();
+    // true, pokud posledni dispatch bezel ve specializovane variante (jinak obecny program)
+    bool UsesSpecializedShader() const { return lastDispatchSpecialized; }
     void ComputeNormals();
+    // Jeden krok eroze modelem erosion.model: kapky (Erosion.comp) nebo mrizkovy model trubek
+    // (HydraulicErosion.comp, erosion.pipeIterations iteraci nad waterAmount a sedimentAmount)
     void ComputeErosion(Erosion erosion);
+    // Planovac eroze, volat jednou za snimek misto ComputeErosion + ComputeNormals: pusti tolik davek kapek
+    // (EROSION_BATCH, u dlazdicove eroze cely krok), kolik se podle GPU timer query vejde do budgetMs.
+    // Krok se muze rozlozit do vice snimku.
+    void UpdateErosion(const Erosion& erosion, float budgetMs);
+    // Offline rezim: iterations kroku eroze co nejrychleji za sebou (blokuje), vraci dobu v ms
+    double RunErosion(const Erosion& erosion, int iterations);
+    int GetErosionBatchesPerFrame() const { return erosionBatchesPerFrame; }
+    double GetErosionBatchTime() const { return msPerErosionBatch; }
+    // Dlazdicova eroze: mrizka se deli na dlazdice tileSize^2, kazda dostane okraj halo texelu od sousedu
+    // a vsechny dlazdice se eroduji v jednom dispatchi. Kapky startuji jen ve vnitrku dlazdice, zmeny v okraji
+    // se prictou sousedum, takze pri halo >= drahy kapky (25 texelu) + polomer stetce je vysledek stejny
+    // jako nad celou mrizkou.
+    void SetTiledErosion(bool enabled, int tileSize = 256, int halo = 32);
+    bool IsTiledErosion() const { return erosionTileSize > 0; }
+    // Prumerna GPU doba jednoho kroku eroze v ms z runs opakovani (GL_TIME_ELAPSED), mrizka se pak obnovi
+    double BenchmarkErosion(const Erosion& erosion, int runs);
     void UpdateTerrain(float scale, float edgeSharpness, float heightScale, int octaves, float persistence, float lacunarity, unsigned int seed);
     void ReadHeightsFromSSBO();
+    void ReadOutputs(std::vector<Output>& outputs);
     void DrawWater(Shader& waterShader, float currentFrame, const glm::mat4& view, const glm::mat4& projection);
     float GetHeightAt(float worldX, float worldZ);
     void ModifyTerrain(glm::vec3 hitPoint, int mode);
@@ -81,12 +137,21 @@ public:
     void SaveHeightmapAsPNG(const std::string& filename);
     void SaveBlendWeightsAsPNG(const std::string& filename);
     void SaveBiomeIDsAsPNG(const std::string& filename);
+    // Offline export sveta worldGrid x worldGrid (zaokrouhleno na nasobek tileSize) mimo pevnou mrizku: kazda
+    // dlazdice se generuje s okrajem halo texelu do vlastniho SSBO, eroduje erosionSteps kroky, orizne a ulozi.
+    // Vysky se normalizuji na spolecny rozsah celeho sveta (druhy pruchod pres docasne float dlazdice), takze
+    // pamet GPU i hosta zavisi jen na tileSize. Rozestup texelu je stejny jako u pevne mrizky, ta je stredem sveta.
+    // Vystup v directory: tile_X_Y_heightmap/biomeids/biomeweights.png, heightmap.r16 a world.txt
+    bool ExportTiled(const std::string& directory, int worldGrid, int tileSize = 1024, int halo = 32,
+        const Erosion& erosion = Erosion(), int erosionSteps = 0);
+    const Uniforms& GetBiomeParams() const { return uniforms; }
     float radius = 10.0f;
     float strength = 2.0f;
     float sigma = radius / 3.0f;
     int gridSize;
     float worldSize;
     int dropletIdx = 0;
+    TerrainSettings settings;
     std::vector<int> chunksToRender;
     std::vector<ChunkDraw> drawOffsets1;
     std::vector<ChunkDraw> drawOffsets2;
@@ -94,6 +159,88 @@ public:
 
 private:
     void GenerateTerrain();
+    void DispatchTerrain();
+    // Klic varianty: bity 0-3 povolene biomy podle ID, pak 5 bitu aktivnich clenu pro Plains, Mountains, Dunes,
+    // v hornich 32 bitech hash kodu grafu sumu (0 = bez grafu)
+    uint64_t VariantKey();
+    std::string VariantDefines(uint64_t key) const;
+    void CompileVariant(uint64_t key, bool waitForCompile);
+    // Prekompiluje grafy po zmene povolenych biomu, aktivnich clenu nebo vlastniho grafu
+    void UpdateNoiseGraphs(uint32_t biomeKey);
+    // HashTerrainParams rozsireny o mapu biomu a vlastni grafy (klice diskove cache a pameti vysledku)
+    uint64_t ParamsHash() const;
+    Shader& SelectTerrainProgram();
+    void ApplyTerrainUniforms(Shader& shader);
+    // Mapa biomu pro aktualni ulohu (jednou na ulohu pred pasy Terrain.comp)
+    void DispatchBiomeMap();
+    // Zapne cteni mapy v programu pro pevnou mrizku (ApplyTerrainUniforms ji vypina)
+    void ApplyBiomeMap(Shader& shader);
+    // Polovina strany tabulky feature bodu v bunkach potrebna pro aktualni parametry
+    int RequiredFeatureExtent() const;
+    // Prestavi tabulku po zmene seedu nebo pri nedostatecnem rozsahu
+    void UpdateFeatureTable();
+    void UpdateBakedNoise();
+    // Vrstvy neplatne od posledniho prepoctu (porovnani settings a uniforms se stavem pri vypoctu)
+    void InvalidateLayers();
+    void DispatchLayerCache();
+    void RequestGeneration();
+    void StartGeneration();
+    void RunGenerationSlices(double budgetMs, bool forceCoarse);
+    void StartLazyGeneration();
+    // Dispatch chunku (dvojice vzdalenost, index chunku), seznam vyprazdni
+    void RunLazyChunks(std::vector<std::pair<float, int>>& chunks, double budgetMs);
+    // Dopocita chunk (pokud jeste neni) a jednou precte jeho vysky do heights pro GetHeightAt
+    void ReadChunkHeights(int chunk);
+    // TerrainFill.comp - doplneni mezer mezi texely s krokem step
+    void DispatchFill(int step);
+    void PollGenerationQuery();
+    void CollectStreamingChunks(glm::vec4 planes[6], glm::vec3 cameraPos);
+    void DispatchStreamChunk(Shader& program, int slot, glm::ivec2 chunk);
+    // Jeden krok eroze (Erosion.comp + ErosionApply.comp) nad mrizkou size x size v bufferu outputs,
+    // ints je pomocny buffer size^2 intu (po kroku vynulovany), dropletStep a dropletOffset urcuji hash kapek
+    void DispatchErosion(GLuint outputs, GLuint ints, int size, const Erosion& erosion, int dropletStep,
+        glm::ivec2 dropletOffset = glm::ivec2(0));
+    void DispatchTiledErosion(const Erosion& erosion, int dropletStep);
+    // Erosion::numDroplets kapek v 1D davkach (Erosion.comp s DROPLET_BATCH), cena nezavisi na gridSize
+    void DispatchDropletErosion(const Erosion& erosion, int dropletStep, int first, int count);
+    // Model trubek: iterations iteraci vody, eroze a advekce sedimentu nad resultsSSBO
+    void DispatchPipeErosion(const Erosion& erosion, int iterations);
+    void ResetPipeErosion();
+    bool StartErosionStep(const Erosion& erosion);
+    void RunErosionBatches(int count);
+    void FinishErosion();
+    // Parametry kapek (vse krome rozmeru mrizky), nastavi program jako aktivni
+    void ApplyErosionUniforms(Shader& shader, const Erosion& erosion, int dropletStep);
+
+    // Klic radku chunku pevne mrizky pro danou historii (0 = cerstve vygenerovany teren)
+    uint64_t GridKey(uint64_t history) const;
+    uint64_t StreamChunkKey(uint64_t paramsHash, glm::ivec2 chunk) const;
+    bool IsGridCached(uint64_t gridKey) const;
+    bool LoadGridFromCache(uint64_t gridKey);
+    bool LoadCachedTerrain();
+    void StoreGridToCache();
+    // Pevna mrizka se zmenila - ulozi se do cache, az bude 1 s beze zmen
+    void MarkGridChanged();
+    void FlushStreamStores();
+    bool LoadResultSnapshot();
+    void StoreResultSnapshot();
+    void ClearResultMemo();
+
+    struct StreamSlot {
+        glm::ivec2 chunk;
+        int version;     // streamVersion, se kterou byl chunk vygenerovan
+        bool resident;   // slot obsahuje vygenerovany chunk
+    };
+
+    struct ResultSnapshot {
+        GLuint buffer;
+        uint64_t lastUsed;
+    };
+
+    struct ShaderVariant {
+        Shader program;
+        uint64_t lastUsed;
+    };
 
     GLuint VAO, VBO, EBOLOD1, EBOLOD2, EBOLOD4;
     GLuint resultsSSBO, uniformBuffer, intsSSBO, chunkPosSSBO, 
@@ -103,6 +250,122 @@ private:
     Shader normalShader;
     Shader erosionApplyShader;
     Uniforms uniforms = { 0 };
+    GLuint generationQuery = 0;
+    bool generationQueryPending = false;
+    double generationTimeMs = 0.0;
+    double queryTexels = 0.0;       // pocet vyhodnocenych texelu v mereni generationQuery
+    double msPerTexel = 1e-5;       // odhad ceny jednoho texelu Terrain.comp, zpresnuje se z mereni
+    std::unordered_map<uint64_t, ShaderVariant> shaderVariants;
+    uint64_t requestedVariant = 0;
+    bool variantRequested = false;
+    uint64_t variantClock = 0;
+    bool lastDispatchSpecialized = false;
+
+    bool layerCacheEnabled = false;
+    std::unique_ptr<Shader> layerShader;     // Terrain.comp s LAYER_PASS
+    std::unique_ptr<Shader> recombineShader; // TerrainRecombine.comp
+    GLuint biomeMapSSBO = 0, layerSSBO = 0;
+    int layerSlots[15];      // slot vrstvy (biomeID - 1) * 5 + clen, -1 = bez slotu
+    int layerSlotCount = 0;
+    int layerSlotCapacity = 0;
+    bool biomeMapValid = false;
+    uint32_t validLayers = 0;
+    TerrainSettings layerSettings;
+    Uniforms layerUniforms = { 0 };
+
+    bool featureTableEnabled = true;
+    std::unique_ptr<Shader> featureShader; // Terrain.comp s FEATURE_PASS
+    GLuint featureSSBO = 0;
+    int featureExtent = 0;   // 0 = tabulka neni postavena
+    unsigned int featureSeed = 0;
+
+    std::unique_ptr<Shader> bakeShader; // Terrain.comp s BAKE_PASS
+    GLuint bakedPerlinTex = 0, bakedSimplexTex = 0;
+    unsigned int bakedSeed = 0;
+
+    bool biomeMapEnabled = false;
+    int biomeMapStep = 4;
+    int biomeMapSize = 0;                 // vzorku na stranu v biomeSampleSSBO
+    std::unique_ptr<Shader> biomeShader;  // Terrain.comp s BIOME_PASS
+    GLuint biomeSampleSSBO = 0;
+
+    int erosionTileSize = 0;  // 0 = eroze nad celou mrizkou
+    int erosionHalo = 32;
+    std::unique_ptr<Shader> tiledErosionShader;  // Erosion.comp s TILED_EROSION
+    std::unique_ptr<Shader> tileGatherShader;    // ErosionTiles.comp s GATHER_PASS
+    std::unique_ptr<Shader> tileReconcileShader; // ErosionTiles.comp
+    GLuint tileHeightsSSBO = 0, tileDeltasSSBO = 0;
+    size_t tileBufferCapacity = 0; // texelu ve vsech dlazdicich vcetne okraju
+    std::unique_ptr<Shader> dropletErosionShader; // Erosion.comp s DROPLET_BATCH
+    GLuint brushSSBO = 0;            // stetec eroze (BuildErosionBrush) pro brushRadius
+    int brushRadius = -1;
+    int brushSize = 0;
+    std::unique_ptr<Shader> pipeShaders[4]; // HydraulicErosion.comp - toky, voda, eroze, advekce
+    GLuint pipeFluxSSBO = 0;         // toky do 4 sousedu (vec4 na texel)
+    GLuint pipeFlowSSBO = 0;         // rychlost, nova vyska a sediment pred advekci (vec4 na texel)
+    uint64_t pipeHistory = 0;        // gridHistory, ke ktere patri toky v pipeFluxSSBO
+    Erosion erosionJob;              // parametry rozpracovaneho kroku eroze
+    int erosionBatch = 0;            // dalsi davka rozpracovaneho kroku
+    int erosionBatches = 0;          // davek v kroku, 0 = zadny rozpracovany krok
+    GLuint erosionQuery = 0;
+    bool erosionQueryPending = false;
+    int erosionQueryBatches = 0;     // davek v mereni erosionQuery
+    double msPerErosionBatch = 1.0;  // odhad ceny davky, zpresnuje se z mereni
+    int erosionBatchesPerFrame = 0;
+
+    bool noiseGraphsEnabled = false;
+    NoiseGraph customGraphs[4];     // podle ID biomu, prazdny = BiomeNoiseGraph
+    NoiseGraph compiledGraphs[4];
+    std::string noiseGraphCode;     // NOISE_GRAPH_CODE pro VariantDefines
+    uint32_t noiseGraphHash = 0;
+    uint32_t noiseGraphBiomeKey = 0; // BiomeKey, pro ktery je noiseGraphCode platny (0 = neplatny)
+    uint64_t customGraphHash = 0;    // 0 = zadny vlastni graf
+
+    std::unique_ptr<Shader> galleryShader; // Terrain.comp s GALLERY_PASS
+    GLuint galleryTex = 0;
+    int galleryThumbSize = 0, galleryColumns = 0, galleryRows = 0;
+    std::vector<unsigned int> gallerySeeds;
+
+    Shader fillShader;
+    bool progressiveEnabled = false;
+    int coarseStep = 8;
+    float frameBudgetMs = 4.0f;
+    bool generationRequested = false; // zmena parametru od posledniho startu ulohy
+    int refineStep = 0;      // krok aktualni urovne ulohy, 0 = zadna uloha
+    int jobCoarseStep = 1;   // krok prvni urovne aktualni ulohy
+    int refineChunkRow = 0;  // dalsi radek chunku aktualni urovne
+
+    bool lazyEnabled = false;
+    bool lazyPending = false;            // nektere chunky maji jen hrubeho zastupce
+    int lazyChunksX = 0;
+    int lazyRemaining = 0;
+    std::vector<uint8_t> chunkGenerated; // 1 = chunk ma plne rozliseni
+    std::vector<uint8_t> chunkHeightsRead; // 1 = vysky chunku uz jsou v heights
+    std::vector<std::pair<float, int>> lazyVisible; // viditelne nedokoncene chunky z posledniho Draw
+
+    bool streamingEnabled = false;
+    int ringSize = 0;
+    GLuint streamSSBO = 0;
+    GLuint streamEBO[3] = { 0, 0, 0 }; // LOD 1, 2, 4 s radkem CHUNK
+    int chunkBufferCapacity = 0;       // pocet chunku v chunkPosSSBO a drawOffsetSSBO*
+    std::vector<StreamSlot> streamSlots;
+    glm::ivec2 ringOrigin = glm::ivec2(0); // chunk v rohu aktualniho okna
+    int streamVersion = 0;                 // zvysuje se pri kazde zmene parametru
+    glm::vec2 lastCameraXZ = glm::vec2(0.0f);
+    glm::vec2 cameraVelocity = glm::vec2(0.0f);
+
+    std::unique_ptr<ChunkCache> chunkCache;
+    bool resumeErosion = true;
+    uint64_t gridHistory = 0;   // retezec hashu eroze a editaci od posledniho generovani
+    bool gridStorePending = false;
+    std::chrono::steady_clock::time_point gridChangedAt;
+    // Chunky prstence vygenerovane minuly snimek, ulozi se po dokonceni na GPU
+    std::vector<std::pair<int, glm::ivec2>> streamStoreQueue;
+
+    std::unordered_map<uint64_t, ResultSnapshot> resultMemo; // klic GridKey(0)
+    uint64_t memoBudgetBytes = 0; // 0 = vypnuto
+    uint64_t memoClock = 0;
+    bool memoStorePending = false;
 
     std::vector<uint32_t> biomeIDs;
     std::vector<float> biomeWeights;
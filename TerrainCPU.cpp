@@ -0,0 +1,794 @@
+#include "TerrainCPU.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+// GLSL fract()
+static glm::vec2 fract(glm::vec2 v) {
+    return v - glm::floor(v);
+}
+
+static float fade(float t) {
+    return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+}
+
+static glm::vec2 fade(glm::vec2 t) {
+    return glm::vec2(fade(t.x), fade(t.y));
+}
+
+static float lerp(float a, float b, float t) {
+    return a + t * (b - a);
+}
+
+static float grad(int hash, float x, float y) {
+    int h = hash & 7;
+    float u = h < 4 ? x : y;
+    float v = h < 2 ? y : x;
+    return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v);
+}
+
+static glm::vec2 grad2(int hash) {
+    static const glm::vec2 G[8] = {
+        glm::vec2(1, 1), glm::vec2(-1, 1), glm::vec2(1, -1), glm::vec2(-1, -1),
+        glm::vec2(1, 0), glm::vec2(-1, 0), glm::vec2(0, 1), glm::vec2(0, -1)
+    };
+    return G[hash & 7];
+}
+
+// Celociselne preteceni v GLSL zalamuje, proto pocitame v unsigned
+int hash(int x, int y, unsigned int seed) {
+    unsigned int ux = static_cast<unsigned int>(x);
+    unsigned int uy = static_cast<unsigned int>(y);
+    ux = (ux + seed) ^ (ux << 13);
+    uy = (uy + seed) ^ (uy << 17);
+    return static_cast<int>(((ux * uy * 15731u + 789221u) ^ (ux + uy * 1376312589u)) & 1023u);
+}
+
+// pcg2d z Terrain.comp - celociselny hash, vysledek je bitove stejny jako na GPU
+static glm::uvec2 pcg2d(glm::uvec2 v) {
+    v = v * 1664525u + 1013904223u;
+    v.x += v.y * 1664525u;
+    v.y += v.x * 1664525u;
+    v ^= v >> 16u;
+    v.x += v.y * 1664525u;
+    v.y += v.x * 1664525u;
+    v ^= v >> 16u;
+    return v;
+}
+
+static glm::vec2 unitHash(glm::uvec2 h) {
+    return glm::vec2(h >> 8u) * (1.0f / 16777216.0f);
+}
+
+glm::vec2 hash(glm::vec2 p, unsigned int seed) {
+    return unitHash(pcg2d(glm::uvec2(glm::ivec2(p)) + glm::uvec2(seed, seed * 2u)));
+}
+
+static glm::vec2 duneHash(glm::vec2 cell) {
+    return unitHash(pcg2d(glm::uvec2(glm::ivec2(cell))));
+}
+
+unsigned int idk_hash(glm::vec2 pos) {
+    return pcg2d(glm::floatBitsToUint(pos)).x;
+}
+
+float perlinNoise(glm::vec2 pos, unsigned int seed) {
+    glm::ivec2 cell = glm::ivec2(glm::floor(pos));
+    glm::vec2 localPos = fract(pos);
+
+    glm::vec2 fadeXY = fade(localPos);
+
+    int h00 = hash(cell.x, cell.y, seed);
+    int h10 = hash(cell.x + 1, cell.y, seed);
+    int h01 = hash(cell.x, cell.y + 1, seed);
+    int h11 = hash(cell.x + 1, cell.y + 1, seed);
+
+    float n00 = grad(h00, localPos.x, localPos.y);
+    float n10 = grad(h10, localPos.x - 1.0f, localPos.y);
+    float n01 = grad(h01, localPos.x, localPos.y - 1.0f);
+    float n11 = grad(h11, localPos.x - 1.0f, localPos.y - 1.0f);
+
+    float nx0 = lerp(n00, n10, fadeXY.x);
+    float nx1 = lerp(n01, n11, fadeXY.x);
+    return lerp(nx0, nx1, fadeXY.y);
+}
+
+static glm::vec2 fadeDeriv(glm::vec2 t) {
+    return 30.0f * t * t * (t * (t - 2.0f) + 1.0f);
+}
+
+// grad() jako vektor: grad(h, x, y) == dot(gradVec(h), (x, y))
+static glm::vec2 gradVec(int hash) {
+    int h = hash & 7;
+    float su = (h & 1) == 0 ? 1.0f : -1.0f;
+    float sv = (h & 2) == 0 ? 1.0f : -1.0f;
+    glm::vec2 gu = h < 4 ? glm::vec2(su, 0.0f) : glm::vec2(0.0f, su);
+    glm::vec2 gv = h < 2 ? glm::vec2(0.0f, sv) : glm::vec2(sv, 0.0f);
+    return gu + gv;
+}
+
+static glm::vec3 scaleDeriv(glm::vec3 noise, float freq) {
+    return glm::vec3(noise.x, noise.y * freq, noise.z * freq);
+}
+
+glm::vec3 perlinNoiseD(glm::vec2 pos, unsigned int seed) {
+    glm::ivec2 cell = glm::ivec2(glm::floor(pos));
+    glm::vec2 localPos = fract(pos);
+
+    glm::vec2 fadeXY = fade(localPos);
+    glm::vec2 dFade = fadeDeriv(localPos);
+
+    int h00 = hash(cell.x, cell.y, seed);
+    int h10 = hash(cell.x + 1, cell.y, seed);
+    int h01 = hash(cell.x, cell.y + 1, seed);
+    int h11 = hash(cell.x + 1, cell.y + 1, seed);
+
+    float n00 = grad(h00, localPos.x, localPos.y);
+    float n10 = grad(h10, localPos.x - 1.0f, localPos.y);
+    float n01 = grad(h01, localPos.x, localPos.y - 1.0f);
+    float n11 = grad(h11, localPos.x - 1.0f, localPos.y - 1.0f);
+
+    float nx0 = lerp(n00, n10, fadeXY.x);
+    float nx1 = lerp(n01, n11, fadeXY.x);
+
+    glm::vec2 dnx0 = glm::mix(gradVec(h00), gradVec(h10), fadeXY.x) + glm::vec2(dFade.x * (n10 - n00), 0.0f);
+    glm::vec2 dnx1 = glm::mix(gradVec(h01), gradVec(h11), fadeXY.x) + glm::vec2(dFade.x * (n11 - n01), 0.0f);
+    glm::vec2 dn = glm::mix(dnx0, dnx1, fadeXY.y) + glm::vec2(0.0f, dFade.y * (nx1 - nx0));
+
+    return glm::vec3(lerp(nx0, nx1, fadeXY.y), dn);
+}
+
+float fbm(glm::vec2 pos, const TerrainSettings& s) {
+    float total = 0.0f;
+    float amplitude = 1.0f;
+    float frequency = 0.5f;
+    float maxValue = 0.0f;
+
+    for (int i = 0; i < s.octaves; i++) {
+        total += perlinNoise(pos * frequency, s.seed) * amplitude;
+        maxValue += amplitude;
+        amplitude *= s.persistence;
+        frequency *= s.lacunarity;
+    }
+
+    return total / maxValue;
+}
+
+glm::vec3 fbmD(glm::vec2 pos, const TerrainSettings& s) {
+    glm::vec3 total = glm::vec3(0.0f);
+    float amplitude = 1.0f;
+    float frequency = 0.5f;
+    float maxValue = 0.0f;
+
+    for (int i = 0; i < s.octaves; i++) {
+        total += scaleDeriv(perlinNoiseD(pos * frequency, s.seed), frequency) * amplitude;
+        maxValue += amplitude;
+        amplitude *= s.persistence;
+        frequency *= s.lacunarity;
+    }
+
+    return total / maxValue;
+}
+
+float simplexNoise(glm::vec2 v, unsigned int seed) {
+    const float F2 = 0.36602540378f;
+    const float G2 = 0.2113248654f;
+
+    glm::vec2 i = glm::floor(v + glm::dot(v, glm::vec2(F2, F2)));
+    glm::vec2 x0 = v - (i - glm::dot(i, glm::vec2(G2, G2)));
+
+    glm::vec2 i1 = (x0.x > x0.y) ? glm::vec2(1, 0) : glm::vec2(0, 1);
+    glm::vec2 x1 = x0 - i1 + glm::vec2(G2, G2);
+    glm::vec2 x2 = x0 - glm::vec2(1.0f, 1.0f) + glm::vec2(2.0f * G2, 2.0f * G2);
+
+    int h0 = hash(int(i.x), int(i.y), seed);
+    int h1 = hash(int(i.x + i1.x), int(i.y + i1.y), seed);
+    int h2 = hash(int(i.x + 1), int(i.y + 1), seed);
+
+    glm::vec2 g0 = grad2(h0);
+    glm::vec2 g1 = grad2(h1);
+    glm::vec2 g2 = grad2(h2);
+
+    float t0 = std::max(0.5f - glm::dot(x0, x0), 0.0f);
+    float t1 = std::max(0.5f - glm::dot(x1, x1), 0.0f);
+    float t2 = std::max(0.5f - glm::dot(x2, x2), 0.0f);
+
+    t0 *= t0; t0 *= t0;
+    t1 *= t1; t1 *= t1;
+    t2 *= t2; t2 *= t2;
+
+    return 70.0f * (t0 * glm::dot(g0, x0) + t1 * glm::dot(g1, x1) + t2 * glm::dot(g2, x2));
+}
+
+glm::vec3 simplexNoiseD(glm::vec2 v, unsigned int seed) {
+    const float F2 = 0.36602540378f;
+    const float G2 = 0.2113248654f;
+
+    glm::vec2 i = glm::floor(v + glm::dot(v, glm::vec2(F2, F2)));
+    glm::vec2 x0 = v - (i - glm::dot(i, glm::vec2(G2, G2)));
+
+    glm::vec2 i1 = (x0.x > x0.y) ? glm::vec2(1, 0) : glm::vec2(0, 1);
+    glm::vec2 x1 = x0 - i1 + glm::vec2(G2, G2);
+    glm::vec2 x2 = x0 - glm::vec2(1.0f, 1.0f) + glm::vec2(2.0f * G2, 2.0f * G2);
+
+    glm::vec2 g0 = grad2(hash(int(i.x), int(i.y), seed));
+    glm::vec2 g1 = grad2(hash(int(i.x + i1.x), int(i.y + i1.y), seed));
+    glm::vec2 g2 = grad2(hash(int(i.x + 1), int(i.y + 1), seed));
+
+    float t0 = std::max(0.5f - glm::dot(x0, x0), 0.0f);
+    float t1 = std::max(0.5f - glm::dot(x1, x1), 0.0f);
+    float t2 = std::max(0.5f - glm::dot(x2, x2), 0.0f);
+
+    float t0_2 = t0 * t0, t1_2 = t1 * t1, t2_2 = t2 * t2;
+    float t0_4 = t0_2 * t0_2, t1_4 = t1_2 * t1_2, t2_4 = t2_2 * t2_2;
+    float d0 = glm::dot(g0, x0), d1 = glm::dot(g1, x1), d2 = glm::dot(g2, x2);
+
+    // d(t^4 * dot(g, x)) = t^4 * g - 8 * t^3 * dot(g, x) * x
+    glm::vec2 dn = t0_4 * g0 - 8.0f * t0_2 * t0 * d0 * x0
+        + t1_4 * g1 - 8.0f * t1_2 * t1 * d1 * x1
+        + t2_4 * g2 - 8.0f * t2_2 * t2 * d2 * x2;
+
+    return 70.0f * glm::vec3(t0_4 * d0 + t1_4 * d1 + t2_4 * d2, dn);
+}
+
+float fbm2(glm::vec2 pos, const TerrainSettings& s) {
+    float total = 0.0f;
+    float amplitude = 1.0f;
+    float frequency = 0.5f;
+    float maxValue = 0.0f;
+
+    for (int i = 0; i < s.octaves; i++) {
+        total += simplexNoise(pos * frequency, s.seed) * amplitude;
+        maxValue += amplitude;
+        amplitude *= s.persistence;
+        frequency *= s.lacunarity;
+    }
+
+    float result = total / maxValue;
+    return result * 0.5f + 0.5f;
+}
+
+glm::vec3 fbm2D(glm::vec2 pos, const TerrainSettings& s) {
+    glm::vec3 total = glm::vec3(0.0f);
+    float amplitude = 1.0f;
+    float frequency = 0.5f;
+    float maxValue = 0.0f;
+
+    for (int i = 0; i < s.octaves; i++) {
+        total += scaleDeriv(simplexNoiseD(pos * frequency, s.seed), frequency) * amplitude;
+        maxValue += amplitude;
+        amplitude *= s.persistence;
+        frequency *= s.lacunarity;
+    }
+
+    glm::vec3 result = total / maxValue;
+    return glm::vec3(result.x * 0.5f + 0.5f, result.y * 0.5f, result.z * 0.5f);
+}
+
+// Spolecne hledani tri nejblizsich bodu (3x3 okoli) pro voronoiNoise i voronoiMap
+static void nearestThree(glm::vec2 pos, unsigned int seed, glm::vec3& first_min, glm::vec3& second_min, glm::vec3& third_min) {
+    glm::vec2 pixel_cell = glm::floor(pos);
+    glm::vec3 poses[9];
+
+    for (int j = -1; j <= 1; j++) {
+        for (int i = -1; i <= 1; i++) {
+            glm::vec2 cell = glm::vec2(float(i), float(j)) + pixel_cell;
+            glm::vec2 posOffset = cell + hash(cell, seed);
+            glm::vec2 off = posOffset - pos;
+            float dist = glm::dot(off, off);
+            int idx = 3 * (j + 1) + (i + 1);
+            poses[idx] = glm::vec3(posOffset, dist);
+        }
+    }
+
+    first_min = glm::vec3(1000);
+    second_min = glm::vec3(1000);
+    third_min = glm::vec3(1000);
+
+    for (int i = 0; i < 9; i++) {
+        if (poses[i].z < first_min.z) first_min = poses[i];
+    }
+    for (int i = 0; i < 9; i++) {
+        if (first_min.z < poses[i].z && poses[i].z < second_min.z) second_min = poses[i];
+    }
+    for (int i = 0; i < 9; i++) {
+        if (second_min.z < poses[i].z && poses[i].z < third_min.z) third_min = poses[i];
+    }
+}
+
+float voronoiNoise(glm::vec2 pos, float edgeSharpness, float baseScale, unsigned int seed) {
+    pos /= baseScale;
+
+    glm::vec3 first_min, second_min, third_min;
+    nearestThree(pos, seed, first_min, second_min, third_min);
+
+    float b1 = std::exp2(-edgeSharpness * first_min.z);
+    float b2 = std::exp2(-edgeSharpness * second_min.z);
+    float b3 = std::exp2(-edgeSharpness * third_min.z);
+
+    glm::vec2 id1 = hash(glm::floor(glm::vec2(first_min)), seed);
+    glm::vec2 id2 = hash(glm::floor(glm::vec2(second_min)), seed);
+    glm::vec2 id3 = hash(glm::floor(glm::vec2(third_min)), seed);
+
+    glm::vec2 id_blend = (id1 * b1 + id2 * b2 + id3 * b3) / (b1 + b2 + b3);
+
+    return id_blend.x;
+}
+
+// d exp2(-sharpness * |p - pos|^2) podle vstupu funkce (pos = vstup / baseScale)
+static glm::vec2 blendDeriv(float b, glm::vec3 nearest, glm::vec2 pos, float edgeSharpness, float baseScale) {
+    const float LN2 = 0.69314718056f;
+    return b * edgeSharpness * LN2 * 2.0f * (glm::vec2(nearest) - pos) / baseScale;
+}
+
+glm::vec3 voronoiNoiseD(glm::vec2 pos, float edgeSharpness, float baseScale, unsigned int seed) {
+    pos /= baseScale;
+
+    glm::vec3 nearest[3];
+    nearestThree(pos, seed, nearest[0], nearest[1], nearest[2]);
+
+    float b[3], id[3];
+    glm::vec2 db[3];
+    for (int k = 0; k < 3; k++) {
+        b[k] = std::exp2(-edgeSharpness * nearest[k].z);
+        db[k] = blendDeriv(b[k], nearest[k], pos, edgeSharpness, baseScale);
+        id[k] = hash(glm::floor(glm::vec2(nearest[k])), seed).x;
+    }
+
+    float bSum = b[0] + b[1] + b[2];
+    float value = (id[0] * b[0] + id[1] * b[1] + id[2] * b[2]) / bSum;
+    glm::vec2 dValue = ((id[0] - value) * db[0] + (id[1] - value) * db[1] + (id[2] - value) * db[2]) / bSum;
+    return glm::vec3(value, dValue);
+}
+
+void voronoiMap(glm::vec2 pos, float edgeSharpness, float scale, unsigned int seed,
+    glm::vec3& first_min, glm::vec3& second_min, glm::vec3& third_min, glm::vec3& weights) {
+    pos /= scale;
+    nearestThree(pos, seed, first_min, second_min, third_min);
+    const glm::vec3 cells[3] = { first_min, second_min, third_min };
+    voronoiWeights(cells, edgeSharpness, weights);
+}
+
+void voronoiWeights(const glm::vec3 cells[3], float edgeSharpness, glm::vec3& weights) {
+    float b1 = std::exp2(-edgeSharpness * cells[0].z);
+    float b2 = std::exp2(-edgeSharpness * cells[1].z);
+    float b3 = std::exp2(-edgeSharpness * cells[2].z);
+
+    weights = glm::vec3(b1, b2, b3) / (b1 + b2 + b3);
+}
+
+void voronoiMapD(glm::vec2 pos, float edgeSharpness, float scale, unsigned int seed,
+    glm::vec3 cells[3], glm::vec3& weights, glm::vec2 dWeights[3]) {
+    glm::vec2 cellPos = pos / scale;
+    nearestThree(cellPos, seed, cells[0], cells[1], cells[2]);
+    voronoiWeightsD(cellPos, edgeSharpness, scale, cells, weights, dWeights);
+}
+
+void voronoiWeightsD(glm::vec2 cellPos, float edgeSharpness, float scale, const glm::vec3 cells[3],
+    glm::vec3& weights, glm::vec2 dWeights[3]) {
+    float b1 = std::exp2(-edgeSharpness * cells[0].z);
+    float b2 = std::exp2(-edgeSharpness * cells[1].z);
+    float b3 = std::exp2(-edgeSharpness * cells[2].z);
+    float bSum = b1 + b2 + b3;
+    weights = glm::vec3(b1, b2, b3) / bSum;
+
+    glm::vec2 db1 = blendDeriv(b1, cells[0], cellPos, edgeSharpness, scale);
+    glm::vec2 db2 = blendDeriv(b2, cells[1], cellPos, edgeSharpness, scale);
+    glm::vec2 db3 = blendDeriv(b3, cells[2], cellPos, edgeSharpness, scale);
+    glm::vec2 dSum = db1 + db2 + db3;
+    dWeights[0] = (db1 - weights.x * dSum) / bSum;
+    dWeights[1] = (db2 - weights.y * dSum) / bSum;
+    dWeights[2] = (db3 - weights.z * dSum) / bSum;
+}
+
+float sandDunes(glm::vec2 pos, float /*edge*/, float baseScale) {
+    pos /= (baseScale / 3);
+    glm::vec2 cell = glm::floor(pos);
+    glm::vec2 localPos = fract(pos);
+
+    float minDist = 10.0f;
+
+    for (int y = -1; y <= 1; y++) {
+        for (int x = -1; x <= 1; x++) {
+            glm::vec2 neighborCell = cell + glm::vec2(x, y);
+            glm::vec2 point = neighborCell + duneHash(neighborCell);
+
+            minDist = std::min(minDist, glm::length(point - (cell + localPos)));
+        }
+    }
+    return minDist;
+}
+
+glm::vec3 sandDunesD(glm::vec2 pos, float /*edge*/, float baseScale) {
+    pos /= (baseScale / 3);
+    glm::vec2 cell = glm::floor(pos);
+    glm::vec2 localPos = fract(pos);
+
+    float minDist = 10.0f;
+    glm::vec2 nearestOff = glm::vec2(0.0f);
+
+    for (int y = -1; y <= 1; y++) {
+        for (int x = -1; x <= 1; x++) {
+            glm::vec2 neighborCell = cell + glm::vec2(x, y);
+            glm::vec2 point = neighborCell + duneHash(neighborCell);
+
+            glm::vec2 off = point - (cell + localPos);
+            float dist = glm::length(off);
+            if (dist < minDist) {
+                minDist = dist;
+                nearestOff = off;
+            }
+        }
+    }
+    glm::vec2 dDist = minDist > 0.0f ? -nearestOff / (minDist * (baseScale / 3)) : glm::vec2(0.0f);
+    return glm::vec3(minDist, dDist);
+}
+
+float ridgeNoise(glm::vec2 pos, const TerrainSettings& s) {
+    float value = fbm2(pos / 5.0f, s) * 2.0f - 1.0f;
+    value = 1.0f - std::abs(value);
+    value *= value;
+    return value;
+}
+
+glm::vec3 ridgeNoiseD(glm::vec2 pos, const TerrainSettings& s) {
+    glm::vec3 fbmValue = fbm2D(pos / 5.0f, s);
+    float value = fbmValue.x * 2.0f - 1.0f;
+    glm::vec2 dValue = glm::vec2(fbmValue.y, fbmValue.z) * (2.0f / 5.0f);
+    float ridge = 1.0f - std::abs(value);
+    glm::vec2 dRidge = -glm::sign(value) * dValue;
+    return glm::vec3(ridge * ridge, 2.0f * ridge * dRidge);
+}
+
+MorphWarp morphWarp(glm::vec2 pos, const TerrainSettings& s) {
+    MorphWarp mw;
+    float base = fbm(pos, s);
+    mw.warp = glm::vec2(base, fbm(pos + glm::vec2(4.3f, 2.1f), s)) * 2.0f;
+    mw.distortion = base * 0.5f;
+    mw.dWarpX = mw.dWarpY = mw.dDistortion = glm::vec2(0.0f);
+    return mw;
+}
+
+MorphWarp morphWarpD(glm::vec2 pos, const TerrainSettings& s) {
+    MorphWarp mw;
+    glm::vec3 base = fbmD(pos, s);
+    glm::vec3 warpY = fbmD(pos + glm::vec2(4.3f, 2.1f), s);
+    mw.warp = glm::vec2(base.x, warpY.x) * 2.0f;
+    mw.distortion = base.x * 0.5f;
+    mw.dWarpX = glm::vec2(base.y, base.z) * 2.0f;
+    mw.dWarpY = glm::vec2(warpY.y, warpY.z) * 2.0f;
+    mw.dDistortion = glm::vec2(base.y, base.z) * 0.5f;
+    return mw;
+}
+
+float combinedNoise(glm::vec2 pos, const Params& params, const MorphWarp& mw, const TerrainSettings& s) {
+    float combined = 0.0f;
+
+    if (params.fbmAmp != 0.0f)
+        combined += fbm(pos * params.fbmFreq, s) * params.fbmAmp;
+    if (params.voroAmp != 0.0f) {
+        combined += voronoiNoise(pos * params.voroFreq, s.edgeSharpness * 0.4f, s.scale * 1.5f, s.seed)
+            * params.voroAmp * 0.8f;
+    }
+    if (params.morphedvoroAmp != 0.0f) {
+        combined += voronoiNoise(pos * params.morphedvoroFreq + mw.warp +
+            mw.distortion, s.edgeSharpness * 0.6f, s.scale * 1.2f, s.seed) * params.morphedvoroAmp * 0.2f;
+    }
+    if (params.ridgeAmp != 0.0f)
+        combined += ridgeNoise(pos * params.ridgeFreq, s) * params.ridgeAmp;
+    if (params.sandAmp != 0.0f)
+        combined += sandDunes(pos * params.sandFreq, s.edgeSharpness, s.scale) * params.sandAmp;
+
+    return combined;
+}
+
+glm::vec3 combinedNoiseD(glm::vec2 pos, const Params& params, const MorphWarp& mw, const TerrainSettings& s) {
+    glm::vec3 combined = glm::vec3(0.0f);
+
+    if (params.fbmAmp != 0.0f)
+        combined += scaleDeriv(fbmD(pos * params.fbmFreq, s), params.fbmFreq) * params.fbmAmp;
+    if (params.voroAmp != 0.0f) {
+        combined += scaleDeriv(voronoiNoiseD(pos * params.voroFreq, s.edgeSharpness * 0.4f, s.scale * 1.5f, s.seed), params.voroFreq)
+            * params.voroAmp * 0.8f;
+    }
+    // q = pos * freq + warp + distortion, derivace pres Jacobiho matici q
+    if (params.morphedvoroAmp != 0.0f) {
+        glm::vec3 morphed = voronoiNoiseD(pos * params.morphedvoroFreq + mw.warp +
+            mw.distortion, s.edgeSharpness * 0.6f, s.scale * 1.2f, s.seed);
+        glm::vec2 dqx = glm::vec2(params.morphedvoroFreq, 0.0f) + mw.dWarpX + mw.dDistortion;
+        glm::vec2 dqy = glm::vec2(0.0f, params.morphedvoroFreq) + mw.dWarpY + mw.dDistortion;
+        combined += glm::vec3(morphed.x, morphed.y * dqx + morphed.z * dqy) * params.morphedvoroAmp * 0.2f;
+    }
+    if (params.ridgeAmp != 0.0f)
+        combined += scaleDeriv(ridgeNoiseD(pos * params.ridgeFreq, s), params.ridgeFreq) * params.ridgeAmp;
+    if (params.sandAmp != 0.0f)
+        combined += scaleDeriv(sandDunesD(pos * params.sandFreq, s.edgeSharpness, s.scale), params.sandFreq) * params.sandAmp;
+
+    return combined;
+}
+
+TerrainCPU::TerrainCPU(int gridSize, float worldSize) : gridSize(gridSize), worldSize(worldSize) {
+}
+
+void TerrainCPU::UpdateTerrain(const TerrainSettings& settings) {
+    this->settings = settings;
+}
+
+void TerrainCPU::UpdateBiomeParams(const Params& dunes, const Params& plains, const Params& mountains, const Params& sea) {
+    uniforms.Dunes = dunes;
+    uniforms.Plains = plains;
+    uniforms.Mountains = mountains;
+    uniforms.Sea = sea;
+}
+
+void TerrainCPU::SetBiomeGraph(int biomeID, const NoiseGraph& graph) {
+    if (biomeID >= 1 && biomeID <= 3)
+        graphs[biomeID] = CompileNoiseGraph(graph);
+}
+
+// Seznam povolenych biomu jako v Terrain.comp, bez povoleneho biomu se generuje Sea
+static unsigned int collectActiveBiomes(const Uniforms& uniforms, const Params* activeBiomes[5], unsigned int activeBiomeIDs[5]) {
+    unsigned int biomeCount = 0;
+
+    if (uniforms.Sea.enabled == 1) {
+        activeBiomes[biomeCount] = &uniforms.Sea;
+        activeBiomeIDs[biomeCount++] = 0;
+    }
+    if (uniforms.Plains.enabled == 1) {
+        activeBiomes[biomeCount] = &uniforms.Plains;
+        activeBiomeIDs[biomeCount++] = 1;
+    }
+    if (uniforms.Mountains.enabled == 1) {
+        activeBiomes[biomeCount] = &uniforms.Mountains;
+        activeBiomeIDs[biomeCount++] = 2;
+    }
+    if (uniforms.Dunes.enabled == 1) {
+        activeBiomes[biomeCount] = &uniforms.Dunes;
+        activeBiomeIDs[biomeCount++] = 3;
+    }
+    if (biomeCount == 0) {
+        activeBiomes[0] = &uniforms.Sea;
+        activeBiomeIDs[0] = 0;
+        biomeCount = 1;
+    }
+    return biomeCount;
+}
+
+float TerrainCPU::GetHeight(float x, float y, unsigned int biomeID[3], glm::vec3& weights) const {
+    glm::vec3 cells[3];
+    nearestThree(glm::vec2(x, y) * 0.1f / settings.scale, settings.seed, cells[0], cells[1], cells[2]);
+    return GetHeight(x, y, cells, biomeID, weights);
+}
+
+float TerrainCPU::GetHeight(float x, float y, const glm::vec3 cells[3], unsigned int biomeID[3], glm::vec3& weights) const {
+    glm::vec2 pos = glm::vec2(x, y) * 0.1f;
+    voronoiWeights(cells, settings.edgeSharpness, weights);
+
+    float seaLevel = -1.0f;
+    float heights[3];
+
+    const Params* activeBiomes[5];
+    unsigned int activeBiomeIDs[5];
+    unsigned int biomeCount = collectActiveBiomes(uniforms, activeBiomes, activeBiomeIDs);
+
+    // Sdilene cleny az pri prvnim biomu, ktery je potrebuje; stejny biom => stejna vyska
+    MorphWarp mw;
+    bool mwReady = false;
+    unsigned int selected[3];
+
+    for (int i = 0; i < 3; i++) {
+        unsigned int biomeHash = idk_hash(glm::vec2(cells[i]));
+        selected[i] = biomeHash % biomeCount;
+        biomeID[i] = activeBiomeIDs[selected[i]];
+
+        if (biomeID[i] == 0) {
+            heights[i] = seaLevel;
+        }
+        else if (i > 0 && selected[i] == selected[0]) {
+            heights[i] = heights[0];
+        }
+        else if (i > 1 && selected[i] == selected[1]) {
+            heights[i] = heights[1];
+        }
+        else if (!graphs[biomeID[i]].Empty()) {
+            heights[i] = EvaluateNoiseGraph(graphs[biomeID[i]], pos, settings, uniforms);
+        }
+        else {
+            const Params& params = *activeBiomes[selected[i]];
+            if (params.morphedvoroAmp != 0.0f && !mwReady) {
+                mw = morphWarp(pos, settings);
+                mwReady = true;
+            }
+            heights[i] = combinedNoise(pos, params, mw, settings);
+        }
+    }
+
+    float finalHeight = heights[0] * weights.x +
+        heights[1] * weights.y +
+        heights[2] * weights.z;
+
+    return finalHeight * settings.heightScale;
+}
+
+glm::vec3 TerrainCPU::ComputeNormal(float x, float z) const {
+    float offset = 0.1f * settings.scale;
+    unsigned int biomeID[3];
+    glm::vec3 nothing;
+    float hL = GetHeight(x - offset, z, biomeID, nothing);
+    float hR = GetHeight(x + offset, z, biomeID, nothing);
+    float hD = GetHeight(x, z - offset, biomeID, nothing);
+    float hU = GetHeight(x, z + offset, biomeID, nothing);
+
+    return glm::normalize(glm::vec3(hL - hR, 1.0f, hD - hU));
+}
+
+float TerrainCPU::GetHeightD(float x, float y, unsigned int biomeID[3], glm::vec3& weights, glm::vec2& gradient) const {
+    glm::vec3 cells[3];
+    nearestThree(glm::vec2(x, y) * 0.1f / settings.scale, settings.seed, cells[0], cells[1], cells[2]);
+    return GetHeightD(x, y, cells, biomeID, weights, gradient);
+}
+
+float TerrainCPU::GetHeightD(float x, float y, const glm::vec3 cells[3], unsigned int biomeID[3], glm::vec3& weights,
+    glm::vec2& gradient) const {
+    glm::vec2 pos = glm::vec2(x, y) * 0.1f;
+
+    glm::vec2 dWeights[3];
+    voronoiWeightsD(pos / settings.scale, settings.edgeSharpness, settings.scale, cells, weights, dWeights);
+
+    float seaLevel = -1.0f;
+    glm::vec3 heights[3];
+
+    const Params* activeBiomes[5];
+    unsigned int activeBiomeIDs[5];
+    unsigned int biomeCount = collectActiveBiomes(uniforms, activeBiomes, activeBiomeIDs);
+
+    MorphWarp mw;
+    bool mwReady = false;
+    unsigned int selected[3];
+
+    for (int i = 0; i < 3; i++) {
+        unsigned int biomeHash = idk_hash(glm::vec2(cells[i]));
+        selected[i] = biomeHash % biomeCount;
+        biomeID[i] = activeBiomeIDs[selected[i]];
+
+        if (biomeID[i] == 0) {
+            heights[i] = glm::vec3(seaLevel, 0.0f, 0.0f);
+        }
+        else if (i > 0 && selected[i] == selected[0]) {
+            heights[i] = heights[0];
+        }
+        else if (i > 1 && selected[i] == selected[1]) {
+            heights[i] = heights[1];
+        }
+        else if (!graphs[biomeID[i]].Empty()) {
+            heights[i] = EvaluateNoiseGraphD(graphs[biomeID[i]], pos, settings, uniforms);
+        }
+        else {
+            const Params& params = *activeBiomes[selected[i]];
+            if (params.morphedvoroAmp != 0.0f && !mwReady) {
+                mw = morphWarpD(pos, settings);
+                mwReady = true;
+            }
+            heights[i] = combinedNoiseD(pos, params, mw, settings);
+        }
+    }
+
+    float finalHeight = heights[0].x * weights.x +
+        heights[1].x * weights.y +
+        heights[2].x * weights.z;
+    glm::vec2 dHeight(0.0f);
+    for (int i = 0; i < 3; i++)
+        dHeight += glm::vec2(heights[i].y, heights[i].z) * weights[i] + heights[i].x * dWeights[i];
+
+    gradient = dHeight * 0.1f * settings.heightScale;
+    return finalHeight * settings.heightScale;
+}
+
+glm::vec3 TerrainCPU::NormalFromGradient(glm::vec2 gradient) const {
+    float offset = 0.1f * settings.scale;
+    return glm::normalize(glm::vec3(-2.0f * offset * gradient.x, 1.0f, -2.0f * offset * gradient.y));
+}
+
+void TerrainCPU::GenerateTile(std::vector<Output>& outputs, int tileX, int tileY) const {
+    float gridDx = worldSize / gridSize;
+    int x0 = tileX * TILE, y0 = tileY * TILE;
+    int x1 = std::min(x0 + TILE, gridSize), y1 = std::min(y0 + TILE, gridSize);
+    int width = x1 - x0;
+
+    // Tri nejblizsi body biomove mapy hleda SIMD kernel po radcich dlazdice, zbytek je po texelech
+    float cellX[TILE], cellY[TILE], nearest[VORONOI_PLANES * TILE];
+
+    for (int y = y0; y < y1; y++) {
+        float worldZ = (float(y) - float(gridSize) / 2.0f) * gridDx;
+        for (int x = x0; x < x1; x++) {
+            float worldX = (float(x) - float(gridSize) / 2.0f) * gridDx;
+            cellX[x - x0] = worldX * 0.1f / settings.scale;
+            cellY[x - x0] = worldZ * 0.1f / settings.scale;
+        }
+        kernels->voronoi3(cellX, cellY, nearest, width, settings.seed);
+
+        for (int x = x0; x < x1; x++) {
+            int i = x - x0;
+            glm::vec3 cells[3];
+            for (int k = 0; k < 3; k++) {
+                cells[k] = glm::vec3(nearest[(3 * k + 0) * width + i],
+                    nearest[(3 * k + 1) * width + i],
+                    nearest[(3 * k + 2) * width + i]);
+            }
+
+            unsigned int biomeID[3];
+            glm::vec3 weights;
+            float worldX = (float(x) - float(gridSize) / 2.0f) * gridDx;
+            float worldY;
+            glm::vec3 normal;
+            if (settings.analyticNormals) {
+                glm::vec2 gradient;
+                worldY = GetHeightD(worldX, worldZ, cells, biomeID, weights, gradient);
+                normal = NormalFromGradient(gradient);
+            }
+            else {
+                worldY = GetHeight(worldX, worldZ, cells, biomeID, weights);
+                normal = ComputeNormal(worldX, worldZ);
+            }
+
+            Output& results = outputs[size_t(y) * gridSize + x];
+            results.position = glm::vec4(worldX, worldY, worldZ, 1.0f);
+            results.normal = glm::vec4(normal, 0.0f);
+            for (int i = 0; i < 3; i++) {
+                results.biomeIDs[i] = biomeID[i];
+                results.biomeWeight[i] = weights[i];
+            }
+            results.waterAmount = 0.0f;
+            results.sedimentAmount = 0.0f;
+        }
+    }
+}
+
+void TerrainCPU::Generate(std::vector<Output>& outputs, int threadCount) const {
+    outputs.resize(size_t(gridSize) * gridSize);
+
+    int tilesPerRow = (gridSize + TILE - 1) / TILE;
+    int tileCount = tilesPerRow * tilesPerRow;
+    if (threadCount <= 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    threadCount = std::min(threadCount, tileCount);
+
+    // Vlakna si berou dlazdice z citace, takze drahe (hornate) dlazdice nebrzdi ostatni
+    std::atomic<int> nextTile(0);
+    auto worker = [&]() {
+        for (int tile = nextTile++; tile < tileCount; tile = nextTile++)
+            GenerateTile(outputs, tile % tilesPerRow, tile / tilesPerRow);
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < threadCount; i++)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread& t : threads)
+        t.join();
+}
+
+size_t TerrainCPU::CountMismatches(const std::vector<Output>& a, const std::vector<Output>& b,
+    float heightScale, size_t* biomeMismatches) {
+    size_t mismatches = 0, biomes = 0;
+    size_t count = std::min(a.size(), b.size());
+    float heightTolerance = GPU_HEIGHT_TOLERANCE * std::max(std::abs(heightScale), 1.0f);
+
+    for (size_t i = 0; i < count; i++) {
+        bool sameBiomes = a[i].biomeIDs[0] == b[i].biomeIDs[0] &&
+            a[i].biomeIDs[1] == b[i].biomeIDs[1] &&
+            a[i].biomeIDs[2] == b[i].biomeIDs[2];
+        if (!sameBiomes) {
+            biomes++;
+            continue;
+        }
+        if (std::abs(a[i].position.y - b[i].position.y) > heightTolerance ||
+            glm::length(glm::vec3(a[i].normal - b[i].normal)) > GPU_NORMAL_TOLERANCE)
+            mismatches++;
+    }
+
+    if (biomeMismatches)
+        *biomeMismatches = biomes;
+    return mismatches;
+}
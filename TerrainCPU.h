@@ -0,0 +1,101 @@
+#ifndef TERRAIN_CPU_H
+#define TERRAIN_CPU_H
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "TerrainTypes.h"
+#include "NoiseGraph.h"
+#include "NoiseKernels.h"
+
+// CPU port sumovych funkci z Shaders/Terrain.comp (stejne nazvy i poradi operaci ve float32).
+int hash(int x, int y, unsigned int seed);
+glm::vec2 hash(glm::vec2 p, unsigned int seed);
+unsigned int idk_hash(glm::vec2 pos);
+float perlinNoise(glm::vec2 pos, unsigned int seed);
+float simplexNoise(glm::vec2 v, unsigned int seed);
+float fbm(glm::vec2 pos, const TerrainSettings& s);
+float fbm2(glm::vec2 pos, const TerrainSettings& s);
+float voronoiNoise(glm::vec2 pos, float edgeSharpness, float baseScale, unsigned int seed);
+void voronoiMap(glm::vec2 pos, float edgeSharpness, float scale, unsigned int seed,
+    glm::vec3& first_min, glm::vec3& second_min, glm::vec3& third_min, glm::vec3& weights);
+// Vahy z uz nalezenych tri nejblizsich bodu (napr. z NoiseKernels::voronoi3)
+void voronoiWeights(const glm::vec3 cells[3], float edgeSharpness, glm::vec3& weights);
+float sandDunes(glm::vec2 pos, float edge, float baseScale);
+float ridgeNoise(glm::vec2 pos, const TerrainSettings& s);
+
+// Warp a distortion morphed Voronoi nezavisi na biomu, pocitaji se jednou na texel (viz Terrain.comp)
+struct MorphWarp {
+    glm::vec2 warp;
+    float distortion;
+    glm::vec2 dWarpX, dWarpY, dDistortion; // derivace podle pos, jen z morphWarpD
+};
+MorphWarp morphWarp(glm::vec2 pos, const TerrainSettings& s);
+MorphWarp morphWarpD(glm::vec2 pos, const TerrainSettings& s);
+// Cleny s nulovou amplitudou se preskakuji
+float combinedNoise(glm::vec2 pos, const Params& params, const MorphWarp& mw, const TerrainSettings& s);
+
+// Varianty s analytickou derivaci (Terrain.comp *D) - vraci (hodnota, d/dx, d/dy)
+glm::vec3 perlinNoiseD(glm::vec2 pos, unsigned int seed);
+glm::vec3 simplexNoiseD(glm::vec2 v, unsigned int seed);
+glm::vec3 fbmD(glm::vec2 pos, const TerrainSettings& s);
+glm::vec3 fbm2D(glm::vec2 pos, const TerrainSettings& s);
+glm::vec3 voronoiNoiseD(glm::vec2 pos, float edgeSharpness, float baseScale, unsigned int seed);
+void voronoiMapD(glm::vec2 pos, float edgeSharpness, float scale, unsigned int seed,
+    glm::vec3 cells[3], glm::vec3& weights, glm::vec2 dWeights[3]);
+void voronoiWeightsD(glm::vec2 cellPos, float edgeSharpness, float scale, const glm::vec3 cells[3],
+    glm::vec3& weights, glm::vec2 dWeights[3]);
+glm::vec3 sandDunesD(glm::vec2 pos, float edge, float baseScale);
+glm::vec3 ridgeNoiseD(glm::vec2 pos, const TerrainSettings& s);
+glm::vec3 combinedNoiseD(glm::vec2 pos, const Params& params, const MorphWarp& mw, const TerrainSettings& s);
+
+// Headless CPU backend pro Terrain.comp - generuje stejne Output zaznamy bez GL kontextu.
+// Mrizka se deli na dlazdice TILE x TILE, ktere si vlakna berou postupne.
+//
+// Tolerance vuci GPU: vypocet bezi ve float32 se stejnym poradim operaci a hashe bunek jsou
+// celociselne (pcg2d), body Voronoi bunek i dun jsou tedy na GPU bitove stejne. Rozdily pochazi
+// z presnosti exp2/pow/sqrt/deleni na GPU (GLSL pripousti nekolik ulp), jinou bunku muze vybrat jen
+// texel, jehoz vzdalenosti ke dvema bodum se lisi o par ulp - ty CountMismatches pocita zvlast.
+// GPU_HEIGHT_TOLERANCE (relativne k heightScale) a GPU_NORMAL_TOLERANCE jsou horni odhad z techto
+// chyb, ne namerena hodnota - proti GPU je overuje tlacitko "Validate CPU Backend", CPU stranu
+// (vlakna, SIMD kernely) hlida TerrashadeBench.
+class TerrainCPU {
+public:
+    static constexpr int TILE = 64;
+    static constexpr float GPU_HEIGHT_TOLERANCE = 1e-3f;
+    static constexpr float GPU_NORMAL_TOLERANCE = 1e-2f;
+
+    TerrainCPU(int gridSize, float worldSize);
+
+    void UpdateTerrain(const TerrainSettings& settings);
+    void UpdateBiomeParams(const Params& dunes, const Params& plains, const Params& mountains, const Params& sea);
+    // Graf sumu biomu s ID 1-3 misto combinedNoise (zkompiluje se), prazdny graf vrati combinedNoise
+    void SetBiomeGraph(int biomeID, const NoiseGraph& graph);
+
+    // Vyplni outputs (gridSize * gridSize) stejne jako dispatch Terrain.comp.
+    // threadCount <= 0 znamena vsechna jadra.
+    void Generate(std::vector<Output>& outputs, int threadCount = 0) const;
+    void GenerateTile(std::vector<Output>& outputs, int tileX, int tileY) const;
+
+    float GetHeight(float x, float y, unsigned int biomeID[3], glm::vec3& weights) const;
+    float GetHeightD(float x, float y, unsigned int biomeID[3], glm::vec3& weights, glm::vec2& gradient) const;
+    // Varianty s uz nalezenymi body biomove mapy (nearestThree v (x, y) * 0.1 / scale)
+    float GetHeight(float x, float y, const glm::vec3 cells[3], unsigned int biomeID[3], glm::vec3& weights) const;
+    float GetHeightD(float x, float y, const glm::vec3 cells[3], unsigned int biomeID[3], glm::vec3& weights,
+        glm::vec2& gradient) const;
+    glm::vec3 ComputeNormal(float x, float z) const;
+    glm::vec3 NormalFromGradient(glm::vec2 gradient) const;
+
+    // Porovnani dvou vystupu (napr. CPU vs. precteny resultsSSBO), vraci pocet texelu mimo toleranci
+    static size_t CountMismatches(const std::vector<Output>& a, const std::vector<Output>& b,
+        float heightScale, size_t* biomeMismatches = nullptr);
+
+    int gridSize;
+    float worldSize;
+    TerrainSettings settings;
+    Uniforms uniforms = { 0 };
+    NoiseGraph graphs[4]; // zkompilovane grafy podle ID biomu
+    // Kernely pro hledani bodu biomove mapy v GenerateTile, vysledek nezavisi na instrukcni sade
+    const NoiseKernels* kernels = &GetNoiseKernels();
+};
+
+#endif // TERRAIN_CPU_H
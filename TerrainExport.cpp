@@ -0,0 +1,87 @@
+#include "TerrainExport.h"
+#include "stb_image_write.h"
+#include <algorithm>
+
+void SplitOutputs(const std::vector<Output>& outputs, std::vector<float>& heights,
+    std::vector<uint32_t>& biomeIDs, std::vector<float>& biomeWeights) {
+    heights.resize(outputs.size());
+    biomeIDs.resize(outputs.size() * 3);  // 3 ID na kazdy bod
+    biomeWeights.resize(outputs.size() * 3); // 3 vahy na kazdy bod
+
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        heights[i] = outputs[i].position.y;
+        for (int j = 0; j < 3; j++) {
+            biomeIDs[i * 3 + j] = outputs[i].biomeIDs[j];
+            biomeWeights[i * 3 + j] = outputs[i].biomeWeight[j];
+        }
+    }
+}
+
+bool WriteHeightmapPNG(const std::string& filename, const std::vector<float>& heights, int gridSize) {
+    if (heights.empty())
+        return false;
+    float minH = *std::min_element(heights.begin(), heights.end());
+    float maxH = *std::max_element(heights.begin(), heights.end());
+    return WriteHeightmapPNG(filename, heights, gridSize, minH, maxH);
+}
+
+bool WriteHeightmapPNG(const std::string& filename, const std::vector<float>& heights, int gridSize, float minH, float maxH) {
+    if (heights.empty() || heights.size() < size_t(gridSize) * gridSize)
+        return false;
+
+    std::vector<uint8_t> imageData(size_t(gridSize) * gridSize);
+
+    float heightRange = maxH - minH;
+    if (heightRange == 0.0f) heightRange = 1.0f;
+
+    for (size_t i = 0; i < imageData.size(); ++i) {
+        imageData[i] = static_cast<uint8_t>(255.0f * std::clamp((heights[i] - minH) / heightRange, 0.0f, 1.0f));
+    }
+
+    return stbi_write_png(filename.c_str(), gridSize, gridSize, 1, imageData.data(), gridSize) != 0;
+}
+
+bool WriteHeightTileR16(std::ostream& file, const std::vector<float>& heights, int tileSize,
+    int x0, int y0, int worldSize, float minH, float maxH) {
+    if (heights.size() < size_t(tileSize) * tileSize)
+        return false;
+    float heightRange = maxH - minH;
+    if (heightRange == 0.0f) heightRange = 1.0f;
+
+    std::vector<uint8_t> row(size_t(tileSize) * 2);
+    for (int y = 0; y < tileSize; y++) {
+        for (int x = 0; x < tileSize; x++) {
+            float h = std::clamp((heights[size_t(y) * tileSize + x] - minH) / heightRange, 0.0f, 1.0f);
+            uint16_t value = static_cast<uint16_t>(65535.0f * h + 0.5f);
+            row[x * 2] = uint8_t(value & 0xFF);
+            row[x * 2 + 1] = uint8_t(value >> 8);
+        }
+        file.seekp((std::streamoff(y0 + y) * worldSize + x0) * 2);
+        file.write(reinterpret_cast<const char*>(row.data()), std::streamsize(row.size()));
+    }
+    return bool(file);
+}
+
+bool WriteBiomeIDsPNG(const std::string& filename, const std::vector<uint32_t>& biomeIDs, int gridSize) {
+    if (biomeIDs.empty() || biomeIDs.size() < size_t(gridSize) * gridSize * 3)
+        return false;
+
+    std::vector<uint8_t> imageData(size_t(gridSize) * gridSize * 3);
+    for (size_t i = 0; i < imageData.size(); ++i) {
+        imageData[i] = static_cast<uint8_t>(biomeIDs[i] * 64);
+    }
+
+    return stbi_write_png(filename.c_str(), gridSize, gridSize, 3, imageData.data(), gridSize * 3) != 0;
+}
+
+bool WriteBlendWeightsPNG(const std::string& filename, const std::vector<float>& biomeWeights, int gridSize) {
+    if (biomeWeights.empty() || biomeWeights.size() < size_t(gridSize) * gridSize * 3)
+        return false;
+
+    std::vector<uint8_t> imageData(size_t(gridSize) * gridSize * 3);
+    for (size_t i = 0; i < imageData.size(); ++i) {
+        imageData[i] = static_cast<uint8_t>(255.0f * biomeWeights[i]);
+    }
+
+    return stbi_write_png(filename.c_str(), gridSize, gridSize, 3, imageData.data(), gridSize * 3) != 0;
+}
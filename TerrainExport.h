@@ -0,0 +1,28 @@
+#ifndef TERRAIN_EXPORT_H
+#define TERRAIN_EXPORT_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "TerrainTypes.h"
+
+// Export vysledku generovani do PNG bez zavislosti na OpenGL (Terrain i terrashade-gen).
+// Funkce nic nevypisuji, aby sly volat z vice vlaken, neuspech hlasi navratovou hodnotou.
+
+// Rozdeli Output zaznamy na vysky a 3 ID / 3 vahy biomu na texel
+void SplitOutputs(const std::vector<Output>& outputs, std::vector<float>& heights,
+    std::vector<uint32_t>& biomeIDs, std::vector<float>& biomeWeights);
+
+// Vyska normalizovana na rozsah min..max, 1 kanal
+bool WriteHeightmapPNG(const std::string& filename, const std::vector<float>& heights, int gridSize);
+// Vyska normalizovana na zadany rozsah minH..maxH (dlazdice sveta se spolecnym rozsahem navazuji)
+bool WriteHeightmapPNG(const std::string& filename, const std::vector<float>& heights, int gridSize, float minH, float maxH);
+// Dlazdice tileSize x tileSize do RAW vyskove mapy sveta worldSize x worldSize (16 bit little-endian, radky
+// po sobe) na texel (x0, y0). Soubor se plni po dlazdicich, v pameti je jen jedna dlazdice.
+bool WriteHeightTileR16(std::ostream& file, const std::vector<float>& heights, int tileSize,
+    int x0, int y0, int worldSize, float minH, float maxH);
+bool WriteBiomeIDsPNG(const std::string& filename, const std::vector<uint32_t>& biomeIDs, int gridSize);
+bool WriteBlendWeightsPNG(const std::string& filename, const std::vector<float>& biomeWeights, int gridSize);
+
+#endif // TERRAIN_EXPORT_H
@@ -0,0 +1,89 @@
+#ifndef TERRAIN_TYPES_H
+#define TERRAIN_TYPES_H
+
+#include <glm/glm.hpp>
+
+// Datove struktury sdilene mezi GPU (Terrain.comp, Erosion.comp) a CPU backendem.
+// Nezavisle na OpenGL, aby sly pouzit i bez GL kontextu.
+
+struct alignas(16) Params {
+    float fbmFreq;
+    float fbmAmp;
+    float ridgeFreq;
+    float ridgeAmp;
+    float voroFreq;
+    float voroAmp;
+    float morphedvoroFreq;
+    float morphedvoroAmp;
+    float sandFreq;
+    float sandAmp;
+    int enabled;
+    int padding1, padding2, padding3;
+};
+
+struct alignas(16) Output {
+    glm::vec4 position;
+    glm::vec4 normal;
+    unsigned int biomeIDs[3];
+    float biomeWeight[3];
+    float waterAmount;
+    float sedimentAmount;
+};
+
+
+struct Uniforms {
+    Params Dunes;
+    Params Plains;
+    Params Mountains;
+    Params Sea;
+};
+
+// Erosion::model - kapky (Erosion.comp) nebo mrizkovy model trubek (HydraulicErosion.comp)
+enum ErosionModel {
+    EROSION_DROPLETS = 0,
+    EROSION_PIPES = 1
+};
+
+struct Erosion {
+    int model = EROSION_DROPLETS;
+    float erosionRate = 1;
+    float depositionRate = 1;
+    int numDroplets = 50000;
+    float inertia = 0.1;
+    float sedimentCapacityFactor = 2.0;
+    float minSedimentCapacity = 0.005;
+    float erodeSpeed = 0.3;
+    float depositSpeed = 0.1;
+    float gravity = 4.0;
+    float initialWaterVolume = 1.0;
+    float initialSpeed = 0.3;
+    int erosionRadius = 3; // polomer stetce eroze a usazovani v texelech
+    // Model trubek, sdili gravity, erodeSpeed a depositSpeed
+    float pipeCapacity = 0.05f;   // kapacita sedimentu na jednotku rychlosti vody a sklonu
+    float rainRate = 0.1f;        // pritok vody za jednotku casu
+    float evaporationRate = 0.5f;
+    float timeStep = 0.05f;       // dt jedne iterace
+    int pipeIterations = 20;      // iteraci v jednom kroku eroze
+};
+
+// Prvek stetce eroze (Brush v Erosion.comp, std430)
+struct BrushTap {
+    glm::ivec2 offset;
+    float weight;
+    float padding;
+};
+
+// Globalni parametry generovani (uniformy Terrain.comp)
+struct TerrainSettings {
+    float scale = 10.0f;
+    float edgeSharpness = 20.0f;
+    float heightScale = 10.0f;
+    int octaves = 8;
+    float persistence = 0.3f;
+    float lacunarity = 2.0f;
+    unsigned int seed = 1337;
+    bool analyticNormals = true; // normala z analytickych derivaci misto 4 dalsich getHeight
+    bool bakedNoise = false;     // fbm/fbm2 z predpecenych dlazdic (jen GPU, CPU backend pocita analyticky)
+};
+
+#endif // TERRAIN_TYPES_H
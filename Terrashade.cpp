@@ -4,6 +4,8 @@
 #include "Camera.h"
 #include "Shader.h"
 #include "Terrain.h"
+#include "TerrainCPU.h"
+#include "ErosionCPU.h"
 #include "Texture.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -238,6 +240,151 @@ void renderGUI(Terrain& terrain, Shader& water, Shader& shader, GLFWwindow* wind
         terrain.SaveBiomeIDsAsPNG("Export/biomeids.png");
         terrain.SaveBlendWeightsAsPNG("Export/biomeweights.png");
     }
+    if (ImGui::Button("Validate CPU Backend")) {
+        // Porovnani GPU vysledku s headless CPU backendem
+        std::vector<Output> gpuOutputs, cpuOutputs;
+        terrain.ReadOutputs(gpuOutputs);
+        TerrainCPU cpu(terrain.gridSize, terrain.worldSize);
+        const Uniforms& biomes = terrain.GetBiomeParams();
+        cpu.UpdateTerrain(terrain.settings);
+        cpu.UpdateBiomeParams(biomes.Dunes, biomes.Plains, biomes.Mountains, biomes.Sea);
+        double start = glfwGetTime();
+        cpu.Generate(cpuOutputs);
+        double elapsed = glfwGetTime() - start;
+        size_t biomeMismatches = 0;
+        size_t mismatches = TerrainCPU::CountMismatches(gpuOutputs, cpuOutputs, terrain.settings.heightScale, &biomeMismatches);
+        std::cout << "CPU backend: " << elapsed << " s, mimo toleranci " << mismatches
+            << " texelu, jiny biom " << biomeMismatches << " z " << cpuOutputs.size() << std::endl;
+    }
+
+    static bool analyticNormals = true;
+    if (ImGui::Checkbox("Analytic Normals", &analyticNormals))
+        terrain.SetAnalyticNormals(analyticNormals);
+    ImGui::SameLine();
+    static bool layerCache = false;
+    // Amplitudy a heightScale jen prekombinuji ulozene vrstvy sumu
+    if (ImGui::Checkbox("Layer Cache", &layerCache))
+        terrain.SetLayerCache(layerCache);
+    static bool progressive = false;
+    static float frameBudget = 4.0f;
+    if (ImGui::Checkbox("Progressive", &progressive))
+        terrain.SetProgressive(progressive);
+    ImGui::SameLine();
+    if (ImGui::SliderFloat("Frame Budget (ms)", &frameBudget, 0.5f, 16.0f))
+        terrain.SetFrameBudget(frameBudget);
+    static bool lazyChunks = false;
+    // Chunky v plnem rozliseni az pri prvni viditelnosti, do te doby hruby zastupce
+    if (ImGui::Checkbox("Lazy Chunks", &lazyChunks))
+        terrain.SetLazyGeneration(lazyChunks);
+    if (lazyChunks) {
+        ImGui::SameLine();
+        ImGui::Text("Pending chunks: %d", terrain.GetPendingChunks());
+    }
+    static bool streaming = false;
+    // Nekonecny svet: prstenec chunku kolem kamery misto pevne mrizky
+    if (ImGui::Checkbox("Streaming", &streaming))
+        terrain.SetStreaming(streaming);
+    static bool resultMemo = false;
+    // Posledni vysledky ve VRAM - navrat k predchozim parametrum je jen kopie bufferu
+    if (ImGui::Checkbox("Result Memo", &resultMemo))
+        terrain.SetResultMemo(resultMemo);
+    if (resultMemo) {
+        ImGui::SameLine();
+        ImGui::Text("%zu snapshots, %.0f MB", terrain.GetResultMemoCount(), terrain.GetResultMemoBytes() / (1024.0 * 1024.0));
+    }
+    static bool diskCache = false;
+    static bool resumeEroded = true;
+    // Hotove chunky na disku - opakovane parametry a kroky eroze se jen nactou
+    if (ImGui::Checkbox("Disk Cache", &diskCache))
+        terrain.SetDiskCache(diskCache, 2048ull * 1024 * 1024, resumeEroded);
+    if (diskCache) {
+        ImGui::SameLine();
+        if (ImGui::Checkbox("Resume Eroded", &resumeEroded))
+            terrain.SetDiskCache(true, 2048ull * 1024 * 1024, resumeEroded);
+        ImGui::SameLine();
+        ImGui::Text("%zu chunks, %.1f MB", terrain.GetDiskCache()->GetEntryCount(),
+            terrain.GetDiskCache()->GetSizeBytes() / (1024.0 * 1024.0));
+    }
+    ImGui::SameLine();
+    ImGui::Text("Generation: %.2f ms (%s)", terrain.GetGenerationTime(),
+        terrain.UsesSpecializedShader() ? "specialized" : "generic");
+    if (ImGui::Button("Benchmark Generation")) {
+        // Porovnani dispatche Terrain.comp s normalou z derivaci a z konecnych diferenci
+        terrain.SetAnalyticNormals(false);
+        double finiteMs = terrain.BenchmarkGeneration(10);
+        terrain.SetAnalyticNormals(true);
+        double analyticMs = terrain.BenchmarkGeneration(10);
+        terrain.SetAnalyticNormals(analyticNormals);
+        std::cout << "Terrain.comp (gridSize " << terrain.gridSize << "): konecne diference " << finiteMs
+            << " ms, analyticke derivace " << analyticMs << " ms" << std::endl;
+    }
+    static bool featureTable = true;
+    ImGui::SameLine();
+    // Feature body Voronoi z tabulky misto hashovani (vysledek je stejny)
+    if (ImGui::Checkbox("Feature Table", &featureTable))
+        terrain.SetFeatureTable(featureTable);
+    static bool bakedNoise = false;
+    // Nahled: fbm z predpecenych dlazdic sumu misto analytickeho vypoctu
+    if (ImGui::Checkbox("Baked Noise", &bakedNoise))
+        terrain.SetBakedNoise(bakedNoise);
+    ImGui::SameLine();
+    if (ImGui::Button("Benchmark Baked Noise")) {
+        terrain.SetBakedNoise(false);
+        double analyticMs = terrain.BenchmarkGeneration(10);
+        terrain.SetBakedNoise(true);
+        double bakedMs = terrain.BenchmarkGeneration(10);
+        terrain.SetBakedNoise(bakedNoise);
+        std::cout << "Terrain.comp (gridSize " << terrain.gridSize << "): analyticke fbm " << analyticMs
+            << " ms, baked dlazdice " << bakedMs << " ms" << std::endl;
+    }
+    if (ImGui::Button("Benchmark Feature Table")) {
+        terrain.SetFeatureTable(false);
+        double hashMs = terrain.BenchmarkGeneration(10);
+        terrain.SetFeatureTable(true);
+        double tableMs = terrain.BenchmarkGeneration(10);
+        terrain.SetFeatureTable(featureTable);
+        std::cout << "Terrain.comp (gridSize " << terrain.gridSize << "): hash " << hashMs
+            << " ms, tabulka feature bodu " << tableMs << " ms" << std::endl;
+    }
+    static bool biomeMap = false;
+    static int biomeMapStep = 4;
+    // Voronoi mapa biomu jen v kazdem biomeMapStep-tem texelu, mezi vzorky se interpoluje
+    bool biomeMapChanged = ImGui::Checkbox("Biome Map", &biomeMap);
+    biomeMapChanged |= ImGui::SliderInt("Biome Map Step", &biomeMapStep, 1, 16);
+    if (biomeMapChanged)
+        terrain.SetBiomeMap(biomeMap, biomeMapStep);
+    if (ImGui::Button("Benchmark Biome Map")) {
+        terrain.SetBiomeMap(false, biomeMapStep);
+        double perTexelMs = terrain.BenchmarkGeneration(10);
+        terrain.SetBiomeMap(true, biomeMapStep);
+        double mapMs = terrain.BenchmarkGeneration(10);
+        terrain.SetBiomeMap(biomeMap, biomeMapStep);
+        std::cout << "Terrain.comp (gridSize " << terrain.gridSize << "): voronoiMap na texel " << perTexelMs
+            << " ms, mapa biomu s krokem " << biomeMapStep << " " << mapMs << " ms" << std::endl;
+    }
+    static bool noiseGraphs = false;
+    // Vysky biomu z grafu sumu zkompilovanych do specializovane varianty Terrain.comp
+    if (ImGui::Checkbox("Noise Graphs", &noiseGraphs))
+        terrain.SetNoiseGraphs(noiseGraphs);
+    if (noiseGraphs) {
+        static int graphBiome = 1; // ID biomu - 1
+        static char graphPath[256] = "Graphs/mountains.graph";
+        ImGui::Combo("Graph Biome", &graphBiome, "Plains\0Mountains\0Dunes\0");
+        ImGui::InputText("Graph File", graphPath, sizeof(graphPath));
+        if (ImGui::Button("Load Graph")) {
+            NoiseGraph graph;
+            std::string error;
+            if (LoadNoiseGraph(graphPath, graph, error))
+                terrain.SetBiomeGraph(graphBiome + 1, graph);
+            else
+                std::cerr << "Graf sumu: " << error << std::endl;
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Reset Graph"))
+            terrain.SetBiomeGraph(graphBiome + 1, NoiseGraph());
+        ImGui::Text("Compiled nodes: Plains %d, Mountains %d, Dunes %d", terrain.GetGraphNodeCount(1),
+            terrain.GetGraphNodeCount(2), terrain.GetGraphNodeCount(3));
+    }
 
 
     // Rezim uprav
@@ -267,8 +414,8 @@ void renderGUI(Terrain& terrain, Shader& water, Shader& shader, GLFWwindow* wind
     static float lacunarity = 2.0f;
     static unsigned int seed = 1337;
     static int seedInput = static_cast<int>(seed);
-    static double erosionPeriod = 0.1;
-    static double lastErosionTime = 0;
+    static float erosionBudget = 4.0f;
+    static int erosionIterations = 100;
     static Params dunesParams = { 0.0, 0.0,  0.0, 0.0,  0.0, 0.0,  0.0, 0.0,  2.0, 0.5, 1 };
     static Params plainsParams = { 0.63, 0.45,  0.0, 0.0,  0.0, 0.0,  0.0, 0.0,  0.0, 0.0, 1 };
     static Params mountainsParams = { 0.0, 0.0,  2.0, 0.8,  0.8, 2.0,  2.0, 2.0,  0.0, 0.0, 1 };
@@ -292,6 +439,52 @@ void renderGUI(Terrain& terrain, Shader& water, Shader& shader, GLFWwindow* wind
     ImGui::SliderFloat("initialSpeed", &erosion.initialSpeed, 0, 10);
     ImGui::SliderFloat("erosionRate", &erosion.erosionRate, 0, 10);
     ImGui::SliderFloat("depositionRate", &erosion.depositionRate, 0, 10);
+    ImGui::SliderInt("erosionRadius", &erosion.erosionRadius, 1, 8);
+    const char* erosionModels[] = { "Droplets", "Pipe Model" };
+    ImGui::Combo("Erosion Model", &erosion.model, erosionModels, IM_ARRAYSIZE(erosionModels));
+    if (erosion.model == EROSION_PIPES) {
+        ImGui::SliderFloat("pipeCapacity", &erosion.pipeCapacity, 0, 1);
+        ImGui::SliderFloat("rainRate", &erosion.rainRate, 0, 5);
+        ImGui::SliderFloat("evaporationRate", &erosion.evaporationRate, 0, 2);
+        ImGui::SliderFloat("timeStep", &erosion.timeStep, 0.001f, 0.2f);
+        ImGui::SliderInt("pipeIterations", &erosion.pipeIterations, 1, 200);
+    }
+
+    static bool tiledErosion = false;
+    static int erosionTileSize = 256;
+    static int erosionHalo = 32;
+    bool tilingChanged = ImGui::Checkbox("Tiled Erosion", &tiledErosion);
+    if (tiledErosion) {
+        tilingChanged |= ImGui::SliderInt("Erosion Tile Size", &erosionTileSize, 64, 1024);
+        tilingChanged |= ImGui::SliderInt("Erosion Halo", &erosionHalo, 0, 64);
+    }
+    if (tilingChanged)
+        terrain.SetTiledErosion(tiledErosion, erosionTileSize, erosionHalo);
+    ImGui::SliderFloat("Erosion Budget (ms)", &erosionBudget, 0.5f, 33.0f);
+    ImGui::Text("Erosion: %d batches/frame, %.3f ms/batch", terrain.GetErosionBatchesPerFrame(),
+        terrain.GetErosionBatchTime());
+    ImGui::InputInt("Iterations", &erosionIterations);
+    erosionIterations = std::max(erosionIterations, 1);
+    ImGui::SameLine();
+    if (ImGui::Button("Run Erosion")) {
+        double ms = terrain.RunErosion(erosion, erosionIterations);
+        std::cout << "Eroze: " << erosionIterations << " kroku za " << ms << " ms\n";
+    }
+    if (ImGui::Button("Benchmark CPU Erosion")) {
+        // Kapky za sekundu GPU (Erosion.comp + ErosionApply.comp) vs. vicevlaknovy CPU port
+        const int runs = 5;
+        double gpuMs = terrain.BenchmarkErosion(erosion, runs);
+        std::vector<Output> outputs;
+        terrain.ReadOutputs(outputs);
+        ErosionCPU cpu(terrain.gridSize);
+        double start = glfwGetTime();
+        for (int i = 0; i < runs; i++)
+            cpu.Step(outputs, erosion, i);
+        double cpuMs = (glfwGetTime() - start) * 1000.0 / runs;
+        double droplets = double(cpu.DropletsPerStep());
+        std::cout << "Eroze " << droplets << " kapek/krok: GPU " << gpuMs << " ms (" << droplets / gpuMs * 1e-3
+            << " Mkapek/s), CPU " << cpuMs << " ms (" << droplets / cpuMs * 1e-3 << " Mkapek/s)" << std::endl;
+    }
 
     ImGui::InputInt("Seed", &seedInput);
     if (seedInput < 0) seedInput = abs(seedInput); // zamezit záporným hodnotám
@@ -308,6 +501,49 @@ void renderGUI(Terrain& terrain, Shader& water, Shader& shader, GLFWwindow* wind
     }
     ImGui::Checkbox("Auto Update", &autoUpdate);
 
+    // Nahledy nahodnych seedu s aktualnimi parametry, kliknuti vygeneruje seed v plnem rozliseni
+    if (ImGui::CollapsingHeader("Seed Gallery")) {
+        if (ImGui::Button("Generate Gallery")) {
+            std::vector<unsigned int> gallerySeeds(16);
+            for (unsigned int& gallerySeed : gallerySeeds)
+                gallerySeed = static_cast<unsigned int>(rand());
+            terrain.GenerateGallery(gallerySeeds);
+        }
+        const std::vector<unsigned int>& gallerySeeds = terrain.GetGallerySeeds();
+        int columns = terrain.GetGalleryColumns();
+        int rows = terrain.GetGalleryRows();
+        ImTextureID atlas = (ImTextureID)(intptr_t)terrain.GetGalleryTexture();
+        for (int i = 0; i < int(gallerySeeds.size()); i++) {
+            int cx = i % columns, cy = i / columns;
+            ImVec2 uv0(float(cx) / columns, float(cy) / rows);
+            ImVec2 uv1(float(cx + 1) / columns, float(cy + 1) / rows);
+            if (cx != 0)
+                ImGui::SameLine();
+            if (ImGui::ImageButton(("##gallery" + std::to_string(i)).c_str(), atlas, ImVec2(64, 64), uv0, uv1)) {
+                seed = gallerySeeds[i];
+                seedInput = static_cast<int>(seed);
+                terrain.UpdateTerrain(terrainScale, edgeSharpness, heightScale, octaves, persistence, lacunarity, seed);
+            }
+            if (ImGui::IsItemHovered())
+                ImGui::SetTooltip("Seed %u", gallerySeeds[i]);
+        }
+    }
+
+    // Offline svet vetsi nez pevna mrizka po dlazdicich s okrajem, eroze s aktualnim nastavenim
+    if (ImGui::CollapsingHeader("Tiled Export")) {
+        static int worldGrid = 16384;
+        static int tileSize = 1024;
+        static int halo = 32;
+        static int erosionSteps = 20;
+        ImGui::InputInt("World Grid", &worldGrid, 1024, 4096);
+        ImGui::SliderInt("Tile Size", &tileSize, 256, 4096);
+        ImGui::SliderInt("Halo", &halo, 0, 128);
+        ImGui::SliderInt("Erosion Steps", &erosionSteps, 0, 200);
+        worldGrid = std::max(worldGrid, tileSize);
+        if (ImGui::Button("Export Tiles"))
+            terrain.ExportTiled("Export/Tiles", worldGrid, tileSize, halo, erosion, erosionSteps);
+    }
+
     bool updated = false;
     updated |= ImGui::SliderFloat("Scale", &terrainScale, 1.0f, 50.0f);
     updated |= ImGui::SliderFloat("Edge Sharpness", &edgeSharpness, 1.0f, 50.0f);
@@ -340,12 +576,8 @@ void renderGUI(Terrain& terrain, Shader& water, Shader& shader, GLFWwindow* wind
         }
     }
 
-    double now = glfwGetTime();
-    if (erosionEnabled && now - lastErosionTime > erosionPeriod) {
-        terrain.ComputeErosion(erosion);
-        terrain.ComputeNormals();
-        lastErosionTime = now;
-    }
+    if (erosionEnabled)
+        terrain.UpdateErosion(erosion, erosionBudget);
 
     if (!autoUpdate)
         ImGui::SameLine();
@@ -628,6 +860,10 @@ int main() {
         ImGui::NewFrame();
 
         renderGUI(terrain, waterShader, terrainShader, window, mouseX, mouseY);
+        // Zmeny parametru z GUI se az tady slouci do jedne ulohy generovani
+        terrain.PollShaderVariants();
+        terrain.UpdateGeneration();
+        terrain.UpdateStreaming(camera.Position, deltaTime);
 
 
         // Výpočet kamerových matic
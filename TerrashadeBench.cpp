@@ -0,0 +1,208 @@
+// Mikrobenchmarky pro Terrashade - vypisuje vzorky/s pro kazdy sumovy kernel a kazdou instrukcni sadu
+// a kapky/s CPU eroze (ErosionCPU) podle poctu vlaken. GPU cestu meri tlacitko "Benchmark CPU Erosion" v GUI.
+// Zaroven je to regresni test CPU backendu bez GL: SIMD kernely musi sedet se skalarni verzi a vystup
+// TerrainCPU i ErosionCPU nesmi zaviset na poctu vlaken, klice cache musi rozlisit rezimy generovani.
+// Pri chybe vraci nenulovy kod.
+#include "ChunkCache.h"
+#include "ErosionCPU.h"
+#include "NoiseKernels.h"
+#include "TerrainCPU.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <thread>
+#include <vector>
+
+static const int SAMPLES = 1 << 16;
+static const double MIN_SECONDS = 0.25;
+
+// Opakuje kernel, dokud nebezi aspon MIN_SECONDS, vraci vzorky za sekundu
+static double MeasureSamplesPerSecond(const std::function<void()>& kernel) {
+    kernel(); // zahrati
+    auto start = std::chrono::steady_clock::now();
+    long long runs = 0;
+    double elapsed = 0.0;
+    do {
+        kernel();
+        runs++;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (elapsed < MIN_SECONDS);
+    return double(runs) * SAMPLES / elapsed;
+}
+
+// Podil hodnot, ktere se od skalarni reference lisi (kernely maji sedet bitove)
+static double MismatchRatio(const std::vector<float>& a, const std::vector<float>& b) {
+    size_t mismatches = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i] != b[i])
+            mismatches++;
+    }
+    return double(mismatches) / double(a.size());
+}
+
+// Vraci pocet kernelu, ktere se lisi od skalarni reference
+static int BenchNoiseKernels() {
+    std::mt19937 rng(1337);
+    std::uniform_real_distribution<float> dist(-200.0f, 200.0f);
+    std::vector<float> x(SAMPLES), y(SAMPLES);
+    for (int i = 0; i < SAMPLES; i++) {
+        x[i] = dist(rng);
+        y[i] = dist(rng);
+    }
+    const unsigned int seed = 1337;
+
+    const NoiseKernels& scalar = *GetNoiseKernels(NoiseISA::Scalar);
+    std::vector<float> refPerlin(SAMPLES), refSimplex(SAMPLES), refVoronoi(SAMPLES * VORONOI_PLANES), refDunes(SAMPLES);
+    scalar.perlin(x.data(), y.data(), refPerlin.data(), SAMPLES, seed);
+    scalar.simplex(x.data(), y.data(), refSimplex.data(), SAMPLES, seed);
+    scalar.voronoi3(x.data(), y.data(), refVoronoi.data(), SAMPLES, seed);
+    scalar.sandDunes(x.data(), y.data(), refDunes.data(), SAMPLES, 10.0f);
+
+    std::printf("Noise kernels (%d samples, selected: %s)\n", SAMPLES, GetNoiseKernels().name);
+    std::printf("%-10s %-10s %14s %12s\n", "ISA", "kernel", "Msamples/s", "mismatch");
+    int failures = 0;
+    auto report = [&](const char* isa, const char* kernel, double samplesPerSecond, double mismatch) {
+        std::printf("%-10s %-10s %14.2f %12.2e\n", isa, kernel, samplesPerSecond * 1e-6, mismatch);
+        if (mismatch > 0.0)
+            failures++;
+    };
+
+    for (int i = 0; i < int(NoiseISA::Count); i++) {
+        const NoiseKernels* k = GetNoiseKernels(NoiseISA(i));
+        if (!k) {
+            std::printf("%-10s (nepodporovano)\n", i == 1 ? "SSE4.2" : i == 2 ? "AVX2" : "AVX-512");
+            continue;
+        }
+        std::vector<float> out(SAMPLES), voro(SAMPLES * VORONOI_PLANES);
+
+        double perlin = MeasureSamplesPerSecond([&]() { k->perlin(x.data(), y.data(), out.data(), SAMPLES, seed); });
+        report(k->name, "perlin", perlin, MismatchRatio(out, refPerlin));
+
+        double simplex = MeasureSamplesPerSecond([&]() { k->simplex(x.data(), y.data(), out.data(), SAMPLES, seed); });
+        report(k->name, "simplex", simplex, MismatchRatio(out, refSimplex));
+
+        double voronoi = MeasureSamplesPerSecond([&]() { k->voronoi3(x.data(), y.data(), voro.data(), SAMPLES, seed); });
+        report(k->name, "voronoi3", voronoi, MismatchRatio(voro, refVoronoi));
+
+        double dunes = MeasureSamplesPerSecond([&]() { k->sandDunes(x.data(), y.data(), out.data(), SAMPLES, 10.0f); });
+        report(k->name, "sandDunes", dunes, MismatchRatio(out, refDunes));
+    }
+    return failures;
+}
+
+// Biomy pro BenchTerrain a BenchErosion - duny, roviny a hory, aby se pouzily vsechny cesty combinedNoise
+static void SetBenchBiomes(TerrainCPU& terrain) {
+    terrain.UpdateBiomeParams({ 0.0, 0.0,  0.0, 0.0,  0.0, 0.0,  0.0, 0.0,  2.0, 0.5, 1 },
+        { 0.63, 0.45,  0.0, 0.0,  0.0, 0.0,  0.0, 0.0,  0.0, 0.0, 1 },
+        { 0.0, 0.0,  2.0, 0.8,  0.8, 2.0,  2.0, 2.0,  0.0, 0.0, 1 },
+        { 0.0, 0.0,  0.0, 0.0,  0.0, 0.0,  0.0, 0.0,  0.0, 0.0, 1 });
+    terrain.UpdateTerrain(TerrainSettings());
+}
+
+// TerrainCPU::Generate podle poctu vlaken a se skalarnimi / vybranymi SIMD kernely, vystup musi byt
+// bitove stejny jako prvni beh (jedno vlakno, skalarni kernely). Vraci pocet behu, ktere se lisi.
+static int BenchTerrain() {
+    const int gridSize = 256;
+    TerrainCPU terrain(gridSize, float(gridSize));
+    SetBenchBiomes(terrain);
+
+    std::printf("\nTerrainCPU (%dx%d)\n", gridSize, gridSize);
+    std::printf("%-10s %-10s %14s %12s\n", "kernels", "threads", "Mtexels/s", "identical");
+
+    int failures = 0;
+    std::vector<Output> reference;
+    int maxThreads = int(std::max(1u, std::thread::hardware_concurrency()));
+    const NoiseKernels* kernelSets[] = { GetNoiseKernels(NoiseISA::Scalar), &GetNoiseKernels() };
+    for (const NoiseKernels* kernels : kernelSets) {
+        terrain.kernels = kernels;
+        for (int threads : { 1, 2, std::max(maxThreads, 3) }) {
+            std::vector<Output> outputs;
+            auto start = std::chrono::steady_clock::now();
+            terrain.Generate(outputs, threads);
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            if (reference.empty())
+                reference = outputs;
+            bool identical = std::memcmp(outputs.data(), reference.data(), outputs.size() * sizeof(Output)) == 0;
+            for (const Output& o : outputs)
+                identical = identical && std::isfinite(o.position.y) && std::isfinite(o.normal.y);
+            if (!identical)
+                failures++;
+            std::printf("%-10s %-10d %14.2f %12s\n", kernels->name, threads, double(outputs.size()) / elapsed * 1e-6,
+                identical ? "yes" : "NO");
+        }
+    }
+    return failures;
+}
+
+// Vraci pocet behu, jejichz vysledek se lisi od behu s jednim vlaknem
+static int BenchErosion() {
+    const int gridSize = 33 * 16;
+    const int steps = 3;
+    TerrainCPU terrain(gridSize, float(gridSize));
+    SetBenchBiomes(terrain);
+    std::vector<Output> initial;
+    terrain.Generate(initial);
+    const Erosion erosion;
+
+    std::printf("\nCPU erosion (%dx%d, %d steps)\n", gridSize, gridSize, steps);
+    std::printf("%-10s %14s %12s\n", "threads", "Mdroplets/s", "identical");
+
+    int failures = 0;
+    std::vector<Output> reference;
+    int maxThreads = int(std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<int> threadCounts;
+    for (int threads = 1; threads < maxThreads; threads *= 2)
+        threadCounts.push_back(threads);
+    threadCounts.push_back(maxThreads);
+    for (int threads : threadCounts) {
+        std::vector<Output> outputs = initial;
+        ErosionCPU cpu(gridSize);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < steps; i++)
+            cpu.Step(outputs, erosion, i, threads);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // Vysledek musi byt bitove stejny jako s jednim vlaknem
+        if (reference.empty())
+            reference = outputs;
+        bool identical = true;
+        for (size_t i = 0; i < outputs.size() && identical; i++)
+            identical = outputs[i].position.y == reference[i].position.y;
+        if (!identical)
+            failures++;
+        std::printf("%-10d %14.2f %12s\n", threads, double(cpu.DropletsPerStep()) * steps / elapsed * 1e-6,
+            identical ? "yes" : "NO");
+    }
+    return failures;
+}
+
+// Klic pameti vysledku a diskove cache (Terrain::ParamsHash) se musi zmenit se zapnutim mapy biomu
+// i s jejim krokem, krok vypnute mapy na nem nezalezi. Vraci pocet porusenych podminek.
+static int CheckCacheKeys() {
+    uint64_t params = HashTerrainParams(TerrainSettings(), Uniforms());
+    uint64_t off = HashBiomeMap(params, false, 4);
+    uint64_t offOtherStep = HashBiomeMap(params, false, 8);
+    uint64_t on = HashBiomeMap(params, true, 4);
+    uint64_t onOtherStep = HashBiomeMap(params, true, 8);
+
+    int failures = (off == on) + (on == onOtherStep) + (off != offOtherStep);
+    std::printf("\nCache keys: biome map %s\n", failures ? "NOT distinguished" : "distinguished");
+    return failures;
+}
+
+int main() {
+    int failures = BenchNoiseKernels();
+    failures += CheckCacheKeys();
+    failures += BenchTerrain();
+    failures += BenchErosion();
+    if (failures) {
+        std::printf("\nFAILED: %d kontrol se lisi od reference\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,269 @@
+// terrashade-gen - davkove generovani terenu pro seznam seedu bez okna a GL kontextu.
+// Pouziva headless CPU backend (TerrainCPU), vystupy jsou stejne jako "Save Heightmap" v GUI.
+//
+// terrashade-gen --seeds 1,5,100-163 [--params soubor] [--grid 1500] [--world 1500] [--out Export] [--jobs N]
+//                [--graph biom=soubor]...
+//
+// Soubor parametru: radky "klic = hodnota", # uvozuje komentar. Klice jsou nazvy z TerrainSettings
+// (scale, edgeSharpness, heightScale, octaves, persistence, lacunarity, analyticNormals), gridSize,
+// worldSize a parametry biomu ve tvaru <biom>.<pole>, napr. mountains.ridgeAmp nebo sea.enabled.
+// --graph nahradi combinedNoise biomu (plains, mountains, dunes) grafem sumu ze souboru (viz NoiseGraph.h).
+#include "TerrainCPU.h"
+#include "TerrainExport.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct GenConfig {
+    TerrainSettings settings;
+    Uniforms uniforms;
+    int gridSize = 1500;
+    float worldSize = 1500.0f;
+    std::string outDir = "Export";
+    std::vector<unsigned int> seeds;
+    int jobs = 0; // 0 = vsechna jadra
+    NoiseGraph graphs[4]; // podle ID biomu, prazdny = combinedNoise
+};
+
+// Vychozi parametry biomu jako v GUI
+static Uniforms DefaultUniforms() {
+    Uniforms u;
+    u.Dunes = { 0.0, 0.0,  0.0, 0.0,  0.0, 0.0,  0.0, 0.0,  2.0, 0.5, 1 };
+    u.Plains = { 0.63, 0.45,  0.0, 0.0,  0.0, 0.0,  0.0, 0.0,  0.0, 0.0, 1 };
+    u.Mountains = { 0.0, 0.0,  2.0, 0.8,  0.8, 2.0,  2.0, 2.0,  0.0, 0.0, 1 };
+    u.Sea = { 0.0, 0.0,  0.0, 0.0,  0.0, 0.0,  0.0, 0.0,  0.0, 0.0, 1 };
+    return u;
+}
+
+static bool SetParamsField(Params& p, const std::string& field, float value) {
+    struct Field { const char* name; float Params::* member; };
+    static const Field fields[] = {
+        { "fbmFreq", &Params::fbmFreq }, { "fbmAmp", &Params::fbmAmp },
+        { "ridgeFreq", &Params::ridgeFreq }, { "ridgeAmp", &Params::ridgeAmp },
+        { "voroFreq", &Params::voroFreq }, { "voroAmp", &Params::voroAmp },
+        { "morphedvoroFreq", &Params::morphedvoroFreq }, { "morphedvoroAmp", &Params::morphedvoroAmp },
+        { "sandFreq", &Params::sandFreq }, { "sandAmp", &Params::sandAmp },
+    };
+    if (field == "enabled") {
+        p.enabled = value != 0.0f;
+        return true;
+    }
+    for (const Field& f : fields) {
+        if (field == f.name) {
+            p.*f.member = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool SetConfigValue(GenConfig& config, const std::string& key, float value) {
+    TerrainSettings& s = config.settings;
+    if (key == "scale") s.scale = value;
+    else if (key == "edgeSharpness") s.edgeSharpness = value;
+    else if (key == "heightScale") s.heightScale = value;
+    else if (key == "octaves") s.octaves = int(value);
+    else if (key == "persistence") s.persistence = value;
+    else if (key == "lacunarity") s.lacunarity = value;
+    else if (key == "analyticNormals") s.analyticNormals = value != 0.0f;
+    else if (key == "gridSize") config.gridSize = int(value);
+    else if (key == "worldSize") config.worldSize = value;
+    else {
+        size_t dot = key.find('.');
+        if (dot == std::string::npos)
+            return false;
+        std::string biome = key.substr(0, dot);
+        Params* p = biome == "dunes" ? &config.uniforms.Dunes : biome == "plains" ? &config.uniforms.Plains :
+            biome == "mountains" ? &config.uniforms.Mountains : biome == "sea" ? &config.uniforms.Sea : nullptr;
+        return p && SetParamsField(*p, key.substr(dot + 1), value);
+    }
+    return true;
+}
+
+static bool LoadParamsFile(GenConfig& config, const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        std::fprintf(stderr, "Chyba: nelze otevrit %s\n", path.c_str());
+        return false;
+    }
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        line = line.substr(0, line.find('#'));
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) {
+            if (line.find_first_not_of(" \t\r") != std::string::npos)
+                std::fprintf(stderr, "%s:%d: chybi '='\n", path.c_str(), lineNumber);
+            continue;
+        }
+        std::string key;
+        std::istringstream(line.substr(0, eq)) >> key;
+        float value = 0.0f;
+        if (!(std::istringstream(line.substr(eq + 1)) >> value) || !SetConfigValue(config, key, value))
+            std::fprintf(stderr, "%s:%d: neznamy klic nebo hodnota '%s'\n", path.c_str(), lineNumber, key.c_str());
+    }
+    return true;
+}
+
+// "1,5,100-163"
+// Seed je uint (uniform v Terrain.comp) - zaporne hodnoty a cisla nad UINT_MAX se odmitaji
+static bool ParseSeed(const char* text, const char*& end, unsigned int& seed) {
+    char* parsed = nullptr;
+    errno = 0;
+    unsigned long long value = std::strtoull(text, &parsed, 10);
+    end = parsed;
+    if (!std::isdigit(static_cast<unsigned char>(*text)) || errno == ERANGE || value > UINT_MAX)
+        return false;
+    seed = static_cast<unsigned int>(value);
+    return true;
+}
+
+static bool ParseSeeds(const std::string& list, std::vector<unsigned int>& seeds) {
+    std::istringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        const char* end = nullptr;
+        unsigned int first, last;
+        if (!ParseSeed(item.c_str(), end, first))
+            return false;
+        last = first;
+        if (*end == '-') {
+            if (!ParseSeed(end + 1, end, last) || last < first)
+                return false;
+        }
+        if (*end != '\0')
+            return false;
+        for (unsigned long long seed = first; seed <= last; seed++)
+            seeds.push_back(static_cast<unsigned int>(seed));
+    }
+    return !seeds.empty();
+}
+
+static void PrintUsage() {
+    std::printf("Pouziti: terrashade-gen --seeds 1,5,100-163 [--params soubor] [--grid N] [--world S] [--out adresar] [--jobs N]\n"
+        "                      [--graph biom=soubor]...\n");
+}
+
+static bool ParseArgs(int argc, char** argv, GenConfig& config) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            PrintUsage();
+            return false;
+        }
+        const char* value = argv[++i];
+        if (arg == "--seeds") {
+            if (!ParseSeeds(value, config.seeds)) {
+                std::fprintf(stderr, "Chyba: neplatny seznam seedu '%s'\n", value);
+                return false;
+            }
+        }
+        else if (arg == "--params") {
+            if (!LoadParamsFile(config, value))
+                return false;
+        }
+        else if (arg == "--grid") config.gridSize = std::atoi(value);
+        else if (arg == "--world") config.worldSize = float(std::atof(value));
+        else if (arg == "--out") config.outDir = value;
+        else if (arg == "--jobs") config.jobs = std::atoi(value);
+        else if (arg == "--graph") {
+            std::string spec = value;
+            size_t eq = spec.find('=');
+            std::string biome = spec.substr(0, eq);
+            int id = biome == "plains" ? 1 : biome == "mountains" ? 2 : biome == "dunes" ? 3 : 0;
+            std::string error = "ocekavano --graph plains|mountains|dunes=soubor";
+            if (eq == std::string::npos || id == 0 || !LoadNoiseGraph(spec.substr(eq + 1), config.graphs[id], error)) {
+                std::fprintf(stderr, "Chyba: %s\n", error.c_str());
+                return false;
+            }
+        }
+        else {
+            PrintUsage();
+            return false;
+        }
+    }
+    if (config.seeds.empty() || config.gridSize <= 0) {
+        PrintUsage();
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    GenConfig config;
+    config.uniforms = DefaultUniforms();
+    if (!ParseArgs(argc, argv, config))
+        return 1;
+    std::error_code ec;
+    std::filesystem::create_directories(config.outDir, ec);
+
+    // Paralelne se zpracovavaji cele seedy ve vlaknech tohoto procesu, ne v samostatnych procesech -
+    // TerrainCPU nema globalni stav, takze staci kazdemu vlaknu vlastni instance a buffery bez synchronizace.
+    // Pri mene seedech nez jader dostane kazdy seed zbytek jader pro sve dlazdice.
+    int cores = int(std::max(1u, std::thread::hardware_concurrency()));
+    int workers = std::min(config.jobs > 0 ? config.jobs : cores, int(config.seeds.size()));
+    int tileThreads = std::max(1, cores / workers);
+
+    std::printf("terrashade-gen: %zu seedu, mrizka %d, %d soubeznych x %d vlaken\n",
+        config.seeds.size(), config.gridSize, workers, tileThreads);
+
+    std::atomic<int> nextSeed(0);
+    std::atomic<int> failures(0);
+    std::atomic<long long> generationNs(0);
+    auto worker = [&]() {
+        TerrainCPU cpu(config.gridSize, config.worldSize);
+        cpu.UpdateBiomeParams(config.uniforms.Dunes, config.uniforms.Plains, config.uniforms.Mountains, config.uniforms.Sea);
+        for (int id = 1; id < 4; id++)
+            cpu.SetBiomeGraph(id, config.graphs[id]);
+        std::vector<Output> outputs;
+        std::vector<float> heights, biomeWeights;
+        std::vector<uint32_t> biomeIDs;
+
+        for (int i = nextSeed++; i < int(config.seeds.size()); i = nextSeed++) {
+            unsigned int seed = config.seeds[i];
+            TerrainSettings settings = config.settings;
+            settings.seed = seed;
+            cpu.UpdateTerrain(settings);
+
+            auto start = std::chrono::steady_clock::now();
+            cpu.Generate(outputs, tileThreads);
+            generationNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+            SplitOutputs(outputs, heights, biomeIDs, biomeWeights);
+            std::string prefix = config.outDir + "/seed" + std::to_string(seed) + "_";
+            bool ok = WriteHeightmapPNG(prefix + "heightmap.png", heights, config.gridSize);
+            ok = WriteBiomeIDsPNG(prefix + "biomeids.png", biomeIDs, config.gridSize) && ok;
+            ok = WriteBlendWeightsPNG(prefix + "biomeweights.png", biomeWeights, config.gridSize) && ok;
+            if (!ok) {
+                failures++;
+                std::fprintf(stderr, "Chyba: export seedu %u do %s selhal\n", seed, config.outDir.c_str());
+            }
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 1; i < workers; i++)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread& t : threads)
+        t.join();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double texels = double(config.gridSize) * config.gridSize * config.seeds.size();
+    std::printf("Hotovo za %.2f s: %.2f Mtexelu/s vcetne exportu, prumerne generovani %.2f s na seed\n",
+        elapsed, texels / elapsed * 1e-6, generationNs * 1e-9 / config.seeds.size());
+    return failures > 0 ? 1 : 0;
+}